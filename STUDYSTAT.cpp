@@ -10,6 +10,17 @@
 #include <ctime>
 #include <iomanip>
 #include <map>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <string_view>
+#include <optional>
+#include <functional>
+#include <memory>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
@@ -17,56 +28,551 @@
 #include <thread>
 #include <atomic>
 #include <filesystem>
+#include <random>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 using namespace std;
 //For file functions
 namespace fs = filesystem;
 //For audio Fuctions
 atomic<bool> breakActive(false);
+mutex breakMutex;
+condition_variable breakEnded;   // wakes the music thread when the break is over
 thread musicThread;
 Mix_Music* backgroundMusic = nullptr;
+// Held for every write to the terminal made while the status ticker may be drawing,
+// so its escape sequences never land in the middle of other output
+mutex consoleMutex;
 
 //-----------TO SHOW TIME,DATE AND DURATION------------------
 namespace Utils {
+    const int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+   
+    int64_t floorDiv(int64_t a, int64_t b) { return a / b - (a % b < 0); }   // b > 0
+   
+    // Days since 1970-01-01 for a proleptic Gregorian date (month 1-12)
+    int32_t daysFromCivil(int year, int month, int day) {
+        year -= month <= 2;
+        int era = (year >= 0 ? year : year - 399) / 400;
+        int yearOfEra = year - era * 400;
+        int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+   
+    // Inverse of daysFromCivil; the conditionals compile to selects, not branches
+    void civilFromDays(int32_t days, int& year, int& month, int& day) {
+        days += 719468;
+        int era = (days >= 0 ? days : days - 146096) / 146097;
+        unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+        unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;   // March = 0
+        day = static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+        month = static_cast<int>(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+        year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2);
+    }
+   
+    // Months since year 0 (year * 12 + month - 1), the key of monthly rollups
+    int32_t monthKey(int32_t days) {
+        int year, month, day;
+        civilFromDays(days, year, month, day);
+        return year * 12 + month - 1;
+    }
+   
+    // -------- local time without localtime()'s shared buffer --------
+    // Each thread caches the UTC offset for one aligned block of 2^21 s (~24 days).
+    // A block holding a DST change also records the second it happens, found by
+    // bisection, so the zone database is only consulted when a lookup leaves the
+    // block. Assumes at most one offset change per block.
+    struct OffsetBlock {
+        int64_t start = 1, end = 0;   // empty until first use
+        int64_t change = 0;           // first second on offsetAfter
+        int32_t offsetBefore = 0, offsetAfter = 0;
+    };
+   
+    int32_t zoneOffset(int64_t t) {
+        time_t at = static_cast<time_t>(t);
+        struct tm local;
+        return localtime_r(&at, &local) ? static_cast<int32_t>(local.tm_gmtoff) : 0;
+    }
+   
+    // Seconds east of UTC in effect at instant t
+    int32_t utcOffset(int64_t t) {
+        const int BLOCK_BITS = 21;
+        thread_local OffsetBlock block;
+        if (t < block.start || t >= block.end) {
+            block.start = floorDiv(t, int64_t(1) << BLOCK_BITS) << BLOCK_BITS;
+            block.end = block.start + (int64_t(1) << BLOCK_BITS);
+            block.offsetBefore = zoneOffset(block.start);
+            block.offsetAfter = zoneOffset(block.end - 1);
+            int64_t lo = block.start, hi = block.end - 1;
+            if (block.offsetBefore == block.offsetAfter) hi = block.end;
+            while (hi - lo > 1 && hi < block.end) {
+                int64_t mid = lo + (hi - lo) / 2;
+                if (zoneOffset(mid) == block.offsetBefore) lo = mid;
+                else hi = mid;
+            }
+            block.change = hi;
+        }
+        return t < block.change ? block.offsetBefore : block.offsetAfter;
+    }
+   
+    // Local calendar day (days since 1970-01-01) containing instant t
+    int32_t localDay(int64_t t) { return static_cast<int32_t>(floorDiv(t + utcOffset(t), SECONDS_PER_DAY)); }
+   
+    // Batch form for bucketing whole columns; consecutive times share cached blocks
+    void localDays(const int64_t* times, size_t n, int32_t* days) {
+        for (size_t i = 0; i < n; i++) days[i] = localDay(times[i]);
+    }
+   
+    // Instant at which a local wall-clock time occurs; inside a DST gap, just after it
+    int64_t fromLocal(int64_t localSeconds) {
+        int64_t guess = localSeconds - utcOffset(localSeconds);
+        return localSeconds - utcOffset(guess);
+    }
+   
+    int64_t localMidnight(int32_t day) { return fromLocal(day * SECONDS_PER_DAY); }
+   
+    // -------- formatting into caller buffers (no allocation) --------
+    const size_t MAX_FORMATTED = 32;   // enough for any date-time or duration below
+   
+    char* writeDigits(char* out, int value, int width) {
+        for (int i = width - 1; i >= 0; i--, value /= 10) out[i] = static_cast<char>('0' + value % 10);
+        return out + width;
+    }
+   
+    // "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS" in local time; returns the end of the text
+    char* writeLocal(char* out, time_t timestamp, bool withTime) {
+        int64_t local = timestamp + utcOffset(timestamp);
+        int32_t days = static_cast<int32_t>(floorDiv(local, SECONDS_PER_DAY));
+        int secondOfDay = static_cast<int>(local - days * SECONDS_PER_DAY);
+        int year, month, day;
+        civilFromDays(days, year, month, day);
+        if (year >= 0 && year <= 9999) out = writeDigits(out, year, 4);
+        else out = to_chars(out, out + 12, year).ptr;
+        *out++ = '-';
+        out = writeDigits(out, month, 2);
+        *out++ = '-';
+        out = writeDigits(out, day, 2);
+        if (!withTime) return out;
+        *out++ = ' ';
+        out = writeDigits(out, secondOfDay / 3600, 2);
+        *out++ = ':';
+        out = writeDigits(out, secondOfDay / 60 % 60, 2);
+        *out++ = ':';
+        return writeDigits(out, secondOfDay % 60, 2);
+    }
+   
+    // "45s", "12m" or "3h 5m"
+    char* writeDuration(char* out, int seconds) {
+        char* end = out + MAX_FORMATTED;
+        if (seconds < 60) {
+            out = to_chars(out, end, seconds).ptr;
+            *out++ = 's';
+        } else if (seconds < 3600) {
+            out = to_chars(out, end, seconds / 60).ptr;
+            *out++ = 'm';
+        } else {
+            out = to_chars(out, end, seconds / 3600).ptr;
+            *out++ = 'h';
+            *out++ = ' ';
+            out = to_chars(out, end, (seconds % 3600) / 60).ptr;
+            *out++ = 'm';
+        }
+        return out;
+    }
+   
     string formatDate(time_t timestamp) {
-        struct tm* timeInfo = localtime(&timestamp);
-        char buffer[20];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d", timeInfo);
-        return string(buffer);
+        char buffer[MAX_FORMATTED];
+        return string(buffer, writeLocal(buffer, timestamp, false));
     }
    
     string formatDateTime(time_t timestamp) {
-        struct tm* timeInfo = localtime(&timestamp);
-        char buffer[25];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeInfo);
-        return string(buffer);
+        char buffer[MAX_FORMATTED];
+        return string(buffer, writeLocal(buffer, timestamp, true));
     }
    
     string formatDuration(int seconds) {
-        if (seconds < 60) return to_string(seconds) + "s";
-        else if (seconds < 3600) return to_string(seconds / 60) + "m";
-        else return to_string(seconds / 3600) + "h " + to_string((seconds % 3600) / 60) + "m";
+        char buffer[MAX_FORMATTED];
+        return string(buffer, writeDuration(buffer, seconds));
     }
    
+    // "YYYY-MM-DD" (anything after the date is ignored) to local midnight; 0 if unparsable
     time_t parseDateTime(const string& dateTimeStr) {
-        struct tm timeInfo = {0};
-        if (dateTimeStr.length() >= 10) {
-            if (sscanf(dateTimeStr.c_str(), "%d-%d-%d",
-                   &timeInfo.tm_year, &timeInfo.tm_mon, &timeInfo.tm_mday) == 3) {
-                timeInfo.tm_year -= 1900;
-                timeInfo.tm_mon -= 1;
-                return mktime(&timeInfo);
-            }
+        int year, month, day;
+        if (dateTimeStr.length() >= 10 &&
+            sscanf(dateTimeStr.c_str(), "%d-%d-%d", &year, &month, &day) == 3 &&
+            month >= 1 && month <= 12 && day >= 1 && day <= 31) {
+            return fromLocal(daysFromCivil(year, month, day) * SECONDS_PER_DAY);
         }
         return 0;
     }
 }
 
+// -------------------- TEXT OUTPUT BUFFER --------------------
+// Screens, charts and reports are formatted once into a growable buffer, with
+// numbers, dates and durations written by to_chars, and the finished bytes are
+// handed to the terminal (and a file) in single writes. clear() keeps the
+// capacity, so a reused buffer stops allocating.
+class TextBuffer {
+private:
+    string text;
+
+public:
+    TextBuffer& operator<<(string_view s) { text.append(s.data(), s.size()); return *this; }
+    TextBuffer& operator<<(char c) { text.push_back(c); return *this; }
+   
+    template <typename T, typename = enable_if_t<is_integral<T>::value && !is_same<T, char>::value &&
+                                                 !is_same<T, bool>::value>>
+    TextBuffer& operator<<(T value) {
+        char digits[24];
+        text.append(digits, to_chars(digits, digits + sizeof(digits), value).ptr);
+        return *this;
+    }
+   
+    TextBuffer& repeat(char c, size_t count) { text.append(count, c); return *this; }
+   
+    TextBuffer& duration(int seconds) {
+        char buffer[Utils::MAX_FORMATTED];
+        text.append(buffer, Utils::writeDuration(buffer, seconds));
+        return *this;
+    }
+   
+    // Stopwatch style "H:MM:SS", for counters that change every second
+    TextBuffer& clock(int64_t seconds) {
+        char buffer[Utils::MAX_FORMATTED];
+        *this << seconds / 3600 << ':';
+        text.append(buffer, Utils::writeDigits(buffer, static_cast<int>(seconds / 60 % 60), 2));
+        text.push_back(':');
+        text.append(buffer, Utils::writeDigits(buffer, static_cast<int>(seconds % 60), 2));
+        return *this;
+    }
+   
+    TextBuffer& date(time_t timestamp) {
+        char buffer[Utils::MAX_FORMATTED];
+        text.append(buffer, Utils::writeLocal(buffer, timestamp, false));
+        return *this;
+    }
+   
+    TextBuffer& dateTime(time_t timestamp) {
+        char buffer[Utils::MAX_FORMATTED];
+        text.append(buffer, Utils::writeLocal(buffer, timestamp, true));
+        return *this;
+    }
+   
+    // Fixed-point with `places` decimals (at most 6), rounded half away from zero
+    TextBuffer& decimal(double value, int places) {
+        long long scale = 1;
+        for (int i = 0; i < places; i++) scale *= 10;
+        long long scaled = llround(value * scale);
+        if (scaled < 0) { text.push_back('-'); scaled = -scaled; }
+        *this << scaled / scale;
+        if (places > 0) {
+            char digits[8];
+            text.push_back('.');
+            text.append(digits, Utils::writeDigits(digits, static_cast<int>(scaled % scale), places));
+        }
+        return *this;
+    }
+   
+    // Field padding like setw: everything written since `from` becomes one column
+    TextBuffer& alignLeft(size_t from, size_t width) {
+        size_t length = text.size() - from;
+        if (length < width) text.append(width - length, ' ');
+        return *this;
+    }
+   
+    TextBuffer& alignRight(size_t from, size_t width) {
+        size_t length = text.size() - from;
+        if (length < width) text.insert(from, width - length, ' ');
+        return *this;
+    }
+   
+    // Left-aligned text padded to `width` (never cut, like setw)
+    TextBuffer& column(string_view s, size_t width) {
+        text.append(s.data(), s.size());
+        if (s.size() < width) text.append(width - s.size(), ' ');
+        return *this;
+    }
+   
+    size_t size() const { return text.size(); }
+    void clear() { text.clear(); }
+    const string& str() const { return text; }
+   
+    bool writeTo(ostream& out) const {
+        out.write(text.data(), text.size());
+        out.flush();
+        return out.good();
+    }
+};
+
+//-----------TEXT SCANNING FOR .dat FILES------------------
+// Finds delimiters 32/16 bytes at a time (AVX2/SSE2, scalar elsewhere) and hands
+// fields out as string_views into the file buffer, so splitting a line allocates nothing.
+namespace TextScan {
+    // First byte in [p, end) equal to a, b or c; repeat a delimiter to search for fewer
+    inline const char* findFirstOf(const char* p, const char* end, char a, char b, char c) {
+#if defined(__AVX2__)
+        const __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b), vc = _mm256_set1_epi8(c);
+        while (end - p >= 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va),
+                                                           _mm256_cmpeq_epi8(chunk, vb)),
+                                           _mm256_cmpeq_epi8(chunk, vc));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+            if (mask) return p + __builtin_ctz(mask);
+            p += 32;
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i sa = _mm_set1_epi8(a), sb = _mm_set1_epi8(b), sc = _mm_set1_epi8(c);
+        while (end - p >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, sa), _mm_cmpeq_epi8(chunk, sb)),
+                                        _mm_cmpeq_epi8(chunk, sc));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            if (mask) return p + __builtin_ctz(mask);
+            p += 16;
+        }
+#endif
+        for (; p < end; ++p)
+            if (*p == a || *p == b || *p == c) return p;
+        return end;
+    }
+
+    // One '|'-separated line; fields past MAX_FIELDS are dropped like the old parser ignored them
+    struct Record {
+        static constexpr int MAX_FIELDS = 8;
+        string_view fields[MAX_FIELDS];
+        int count = 0;
+        string_view line;
+
+        string_view operator[](int i) const { return i < count ? fields[i] : string_view(); }
+    };
+
+    // Walks a whole-file buffer line by line, skipping empty lines
+    class LineScanner {
+    private:
+        const char* pos;
+        const char* end;
+
+    public:
+        LineScanner(const char* data, size_t size) : pos(data), end(data + size) {}
+
+        bool next(Record& record) {
+            while (pos < end) {
+                const char* lineStart = pos;
+                const char* fieldStart = pos;
+                record.count = 0;
+                while (true) {
+                    const char* d = findFirstOf(pos, end, '|', '\n', '\n');
+                    if (record.count < Record::MAX_FIELDS)
+                        record.fields[record.count++] = string_view(fieldStart, d - fieldStart);
+                    if (d == end || *d == '\n') {
+                        record.line = string_view(lineStart, d - lineStart);
+                        pos = (d == end) ? end : d + 1;
+                        break;
+                    }
+                    pos = fieldStart = d + 1;
+                }
+                if (!record.line.empty()) return true;
+            }
+            return false;
+        }
+    };
+
+    // Calls f(string_view) for each part of s split on delim
+    template <typename F>
+    void forEachPart(string_view s, char delim, F f) {
+        const char* p = s.data();
+        const char* end = p + s.size();
+        while (true) {
+            const char* d = findFirstOf(p, end, delim, delim, delim);
+            f(string_view(p, d - p));
+            if (d == end) return;
+            p = d + 1;
+        }
+    }
+
+    template <typename T>
+    T toNumber(string_view s, T fallback = 0) {
+        T value = fallback;
+        auto result = from_chars(s.data(), s.data() + s.size(), value);
+        return result.ec == errc() ? value : fallback;
+    }
+
+    bool readFile(const string& filename, string& out) {
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file.is_open()) return false;
+        streamsize size = file.tellg();
+        out.resize(size > 0 ? size : 0);
+        file.seekg(0);
+        return size <= 0 || static_cast<bool>(file.read(&out[0], size));
+    }
+}
+
+//-----------CHECKSUMS AND CRASH-SAFE FILE WRITES------------------
+namespace Checksum {
+    // CRC-32C (Castagnoli); uses the SSE4.2 crc32 instruction when it is available
+    uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+#if defined(__SSE4_2__)
+        while (size >= 8) {
+            uint64_t word;
+            memcpy(&word, p, sizeof(word));
+            crc = static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+            p += 8;
+            size -= 8;
+        }
+        while (size--) crc = _mm_crc32_u8(crc, *p++);
+#else
+        static const auto table = [] {
+            array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        while (size--) crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+#endif
+        return ~crc;
+    }
+}
+
+// Checkpoints are written to <file>.tmp, fsync'd and renamed over <file>. The
+// checkpoint being replaced is kept as <file>.prev so recovery can fall back to it.
+namespace Checkpoint {
+    string previous(const string& path) { return path + ".prev"; }
+
+    bool syncDirectoryOf(const string& path) {
+        string dir = fs::path(path).parent_path().string();
+        int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        bool synced = fsync(fd) == 0;
+        ::close(fd);
+        return synced;
+    }
+
+    bool writeFile(const string& path, const void* data, size_t size) {
+        string tmpPath = path + ".tmp";
+        int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        const char* p = static_cast<const char*>(data);
+        size_t left = size;
+        while (left > 0) {
+            ssize_t written = write(fd, p, left);
+            if (written <= 0) {
+                ::close(fd);
+                unlink(tmpPath.c_str());
+                return false;
+            }
+            p += written;
+            left -= written;
+        }
+        if (fsync(fd) != 0) {
+            ::close(fd);
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        ::close(fd);
+
+        // Hard-link the current checkpoint as .prev so there is never a moment without one.
+        // The first checkpoint has nothing to link (ENOENT).
+        string prevPath = previous(path);
+        unlink(prevPath.c_str());
+        if (link(path.c_str(), prevPath.c_str()) != 0 && errno != ENOENT) {
+            cerr << "Could not keep a backup of " << path << ": " << strerror(errno) << endl;
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        return syncDirectoryOf(path);
+    }
+
+    // Text checkpoints end with a "CRC32C <hex>" line covering everything before it
+    string sealText(const string& text) {
+        char line[32];
+        snprintf(line, sizeof(line), "CRC32C %08x\n", Checksum::crc32c(text.data(), text.size()));
+        return text + line;
+    }
+
+    // Verifies and strips the checksum line; files from before checksums have none and pass
+    bool unsealText(string& text) {
+        size_t end = text.size();
+        if (end > 0 && text[end - 1] == '\n') end--;
+        size_t lineStart = text.rfind('\n', end ? end - 1 : 0);
+        lineStart = (lineStart == string::npos || end == 0) ? 0 : lineStart + 1;
+        if (text.compare(lineStart, 7, "CRC32C ") != 0) return true;
+
+        uint32_t stored = 0;
+        auto parsed = from_chars(text.data() + lineStart + 7, text.data() + end, stored, 16);
+        if (parsed.ec != errc() || stored != Checksum::crc32c(text.data(), lineStart)) return false;
+        text.resize(lineStart);
+        return true;
+    }
+}
+
 // ---------------CLASSES-------------------------------
 //-------------------STUDYSESSION CLASS------------------
+// -------------------- SUBJECT DICTIONARY --------------------
+// Per-user table of distinct subjects; sessions and todos keep a small id instead of a string
+using SubjectId = uint32_t;
+
+class SubjectDictionary {
+private:
+    deque<string> names;                          // deque never moves entries, so the keys below stay valid
+    unordered_map<string_view, SubjectId> ids;
+
+public:
+    static constexpr SubjectId NONE = 0;          // the empty subject
+
+    SubjectDictionary() { intern(""); }
+    SubjectDictionary(const SubjectDictionary&) = delete;
+    SubjectDictionary& operator=(const SubjectDictionary&) = delete;
+
+    SubjectId intern(string_view name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        names.emplace_back(name);
+        SubjectId id = names.size() - 1;
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    // Lookup without adding; false when no record uses this subject
+    bool find(string_view name, SubjectId& id) const {
+        auto it = ids.find(name);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    const string& name(SubjectId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+};
+
+// ==================== STUDY SESSION CLASS ====================
 class StudySession {
 private:
     int id;
-    string subject;
+    const SubjectDictionary* subjects;
+    SubjectId subjectId;
     time_t startTime;
     time_t endTime;
     int duration;
@@ -76,11 +582,17 @@ private:
     vector<string> attachedFiles;
 
 public:
-    StudySession(int id, const string& subject, time_t startTime, time_t endTime, const string& notes = "", int breakTime = 0)
-        : id(id), subject(subject), startTime(startTime), endTime(endTime), notes(notes), breakTime(breakTime) {
+    StudySession(const SubjectDictionary& subjects, int id, SubjectId subjectId, time_t startTime, time_t endTime,
+                 const string& notes = "", int breakTime = 0)
+        : id(id), subjects(&subjects), subjectId(subjectId), startTime(startTime), endTime(endTime),
+          notes(notes), breakTime(breakTime) {
         duration = difftime(endTime, startTime) - breakTime;
     }
    
+    StudySession(SubjectDictionary& subjects, int id, string_view subject, time_t startTime, time_t endTime,
+                 const string& notes = "", int breakTime = 0)
+        : StudySession(subjects, id, subjects.intern(subject), startTime, endTime, notes, breakTime) {}
+   
     int getBreakTime() const { return breakTime; }
     void setBreakTime(int time) {
         breakTime = time;
@@ -90,17 +602,18 @@ public:
    
     //
     int getId() const { return id; }
-    string getSubject() const { return subject; }
+    SubjectId getSubjectId() const { return subjectId; }
+    const string& getSubject() const { return subjects->name(subjectId); }
     time_t getStartTime() const { return startTime; }
     time_t getEndTime() const { return endTime; }
     int getDuration() const { return duration; }
-    string getNotes() const { return notes; }
+    const string& getNotes() const { return notes; }
    
     //-------FOR IMAGE HANDLING-----------
     void attachImage(const string& path) {
         attachedImagePath = path;
     }
-    string getAttachedImage() const {
+    const string& getAttachedImage() const {
         return attachedImagePath;
     }
 
@@ -109,31 +622,42 @@ public:
     void attachFile(const string& path) {
         attachedFiles.push_back(path);
     }
-    vector<string> getAttachedFiles() const {
+    const vector<string>& getAttachedFiles() const {
         return attachedFiles;
     }
 
-    string toString() const {
-        stringstream ss;
-        ss << "Session #" << id << ": " << subject << " | "
-           << "Start: " << Utils::formatDateTime(startTime) << " | "
-           << "End: " << Utils::formatDateTime(endTime) << " | "
-           << "Duration: " << Utils::formatDuration(duration);
+    // Shared with SessionView, which formats rows straight from the session table
+    static void describe(TextBuffer& out, int id, const string& subject, time_t startTime, time_t endTime,
+                         int duration, int breakTime, const string& notes, bool hasImage, size_t fileCount) {
+        out << "Session #" << id << ": " << subject << " | Start: ";
+        out.dateTime(startTime) << " | End: ";
+        out.dateTime(endTime) << " | Duration: ";
+        out.duration(duration);
         if (breakTime > 0) {
-            ss << " | Break time: " << Utils::formatDuration(breakTime);
+            out << " | Break time: ";
+            out.duration(breakTime);
         }
-        if (!notes.empty()) ss << " | Notes: " << notes;
+        if (!notes.empty()) out << " | Notes: " << notes;
        
        
-        if (!attachedImagePath.empty()) ss << " | [Has Image]";
-        if (!attachedFiles.empty()) ss << " | [Has " << attachedFiles.size() << " Files]";
-       
-        return ss.str();
+        if (hasImage) out << " | [Has Image]";
+        if (fileCount > 0) out << " | [Has " << fileCount << " Files]";
+    }
+   
+    void describe(TextBuffer& out) const {
+        describe(out, id, getSubject(), startTime, endTime, duration, breakTime, notes,
+                 !attachedImagePath.empty(), attachedFiles.size());
+    }
+   
+    string toString() const {
+        TextBuffer out;
+        describe(out);
+        return out.str();
     }
    
     string serialize() const {
         stringstream ss;
-        ss << id << "|" << subject << "|" << startTime << "|" << endTime << "|" << notes << "|" << breakTime;
+        ss << id << "|" << getSubject() << "|" << startTime << "|" << endTime << "|" << notes << "|" << breakTime;
         ss << "|" << attachedImagePath;
        
         // Serialize attached files
@@ -146,831 +670,4638 @@ public:
         return ss.str();
     }
    
-    static StudySession deserialize(const string& data) {
-        stringstream ss(data);
-        string item;
-        vector<string> parts;
-       
-        while (getline(ss, item, '|')) parts.push_back(item);
-       
-        if (parts.size() >= 4) {
-            int breakTime = (parts.size() > 5) ? stoi(parts[5]) : 0;
-            StudySession session(stoi(parts[0]), parts[1], stoll(parts[2]),
-                             stoll(parts[3]), parts.size() > 4 ? parts[4] : "", breakTime);
+    static StudySession fromRecord(const TextScan::Record& parts, SubjectDictionary& subjects) {
+        if (parts.count >= 4) {
+            int breakTime = TextScan::toNumber<int>(parts[5]);
+            StudySession session(subjects, TextScan::toNumber<int>(parts[0]), parts[1],
+                                 TextScan::toNumber<time_t>(parts[2]), TextScan::toNumber<time_t>(parts[3]),
+                                 string(parts[4]), breakTime);
            
             // Load attached image if available
-            if (parts.size() > 6 && !parts[6].empty()) {
-                session.attachImage(parts[6]);
+            if (!parts[6].empty()) {
+                session.attachImage(string(parts[6]));
             }
            
             // Load attached files if available
-            if (parts.size() > 7 && !parts[7].empty()) {
-                stringstream filesSS(parts[7]);
-                string file;
-                while (getline(filesSS, file, ',')) {
-                    session.attachFile(file);
-                }
+            if (!parts[7].empty()) {
+                TextScan::forEachPart(parts[7], ',', [&session](string_view file) {
+                    session.attachFile(string(file));
+                });
             }
            
             return session;
         }
-        return StudySession(0, "Unknown", 0, 0);
+        return StudySession(subjects, 0, "Unknown", 0, 0);
+    }
+   
+    static StudySession deserialize(const string& data, SubjectDictionary& subjects) {
+        TextScan::LineScanner scanner(data.data(), data.size());
+        TextScan::Record record;
+        scanner.next(record);
+        return fromRecord(record, subjects);
     }
 };
 
-// -------------------- TODOITEM CLASS ------------------------------
-class TodoItem {
-private:
-    int id;
-    string description;
-    bool completed;
-    int priority;
-    time_t dueDate;
-    string subject;
-
-public:
-    TodoItem(int id, const string& desc, int priority = 2,
-           time_t dueDate = 0, const string& subject = "", bool completed = false)
-        : id(id), description(desc), completed(completed),
-          priority(priority), dueDate(dueDate), subject(subject) {}
-   
-    int getId() const { return id; }
-    string getDescription() const { return description; }
-    bool isCompleted() const { return completed; }
-    int getPriority() const { return priority; }
-    time_t getDueDate() const { return dueDate; }
-    string getSubject() const { return subject; }
-    void setCompleted(bool status) { completed = status; }
-   
-    string getPriorityString() const {
-        switch (priority) {
-            case 1: return "High";
-            case 2: return "Medium";
-            case 3: return "Low";
-            default: return "Unknown";
+// -------------------- COLUMN KERNELS --------------------
+// Aggregations over raw session columns, 8 lanes at a time with AVX2 and 4 with SSE2.
+// They take plain pointers so they run on the in-memory table and on a mapped file alike.
+namespace ColumnKernels {
+    inline int64_t sum(const int32_t* values, size_t n) {
+        size_t i = 0;
+        int64_t total = 0;
+#if defined(__AVX2__)
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
         }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+#if defined(__SSE2__)
+        __m128i acc2 = _mm_setzero_si128();
+        for (; i + 4 <= n; i += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            __m128i sign = _mm_srai_epi32(x, 31);   // sign-extend to 64 bits without SSE4.1
+            acc2 = _mm_add_epi64(acc2, _mm_unpacklo_epi32(x, sign));
+            acc2 = _mm_add_epi64(acc2, _mm_unpackhi_epi32(x, sign));
+        }
+        alignas(16) int64_t pair[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(pair), acc2);
+        total += pair[0] + pair[1];
+#endif
+        for (; i < n; i++) total += values[i];
+        return total;
     }
-   
-    string toString() const {
-        stringstream ss;
-        ss << "[" << (completed ? "X" : " ") << "] " << description;
-        if (!subject.empty()) ss << " (" << subject << ")";
-        ss << " - Priority: " << getPriorityString();
-        if (dueDate > 0) ss << ", Due: " << Utils::formatDate(dueDate);
-        return ss.str();
+
+    // False for an empty column
+    inline bool minMax(const int32_t* values, size_t n, int32_t& lo, int32_t& hi) {
+        if (n == 0) return false;
+        size_t i = 0;
+        lo = hi = values[0];
+#if defined(__AVX2__)
+        if (n >= 8) {
+            __m256i vlo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+            __m256i vhi = vlo;
+            for (i = 8; i + 8 <= n; i += 8) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                vlo = _mm256_min_epi32(vlo, x);
+                vhi = _mm256_max_epi32(vhi, x);
+            }
+            alignas(32) int32_t l[8], h[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(l), vlo);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(h), vhi);
+            for (int k = 0; k < 8; k++) { lo = min(lo, l[k]); hi = max(hi, h[k]); }
+        }
+#elif defined(__SSE2__)
+        if (n >= 4) {
+            __m128i vlo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+            __m128i vhi = vlo;
+            for (i = 4; i + 4 <= n; i += 4) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+                __m128i lower = _mm_cmplt_epi32(x, vlo), higher = _mm_cmpgt_epi32(x, vhi);
+                vlo = _mm_or_si128(_mm_and_si128(lower, x), _mm_andnot_si128(lower, vlo));
+                vhi = _mm_or_si128(_mm_and_si128(higher, x), _mm_andnot_si128(higher, vhi));
+            }
+            alignas(16) int32_t l[4], h[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(l), vlo);
+            _mm_store_si128(reinterpret_cast<__m128i*>(h), vhi);
+            for (int k = 0; k < 4; k++) { lo = min(lo, l[k]); hi = max(hi, h[k]); }
+        }
+#endif
+        for (; i < n; i++) { lo = min(lo, values[i]); hi = max(hi, values[i]); }
+        return true;
     }
-   
-    string serialize() const {
-        stringstream ss;
-        ss << id << "|" << description << "|" << (completed ? "1" : "0") << "|"
-           << priority << "|" << dueDate << "|" << subject;
-        return ss.str();
+
+    // counts[b] += number of values in [b * width, (b + 1) * width). Values below zero
+    // count in the first bucket and values past the range in the last.
+    inline void histogram(const int32_t* values, size_t n, int32_t width, uint32_t* counts, size_t buckets) {
+        if (width <= 0 || buckets == 0) return;
+        int64_t range = static_cast<int64_t>(width) * buckets;
+        int32_t top = static_cast<int32_t>(min<int64_t>(range, INT32_MAX) - 1);
+        size_t i = 0;
+#if defined(__AVX2__)
+        // Float division is exact to within one bucket below 2^24; the integer check fixes that one.
+        // Lanes count into four private copies so repeated buckets don't serialize on one counter.
+        const size_t MAX_SPLIT_BUCKETS = 64;
+        if (range <= (1 << 24) && buckets <= MAX_SPLIT_BUCKETS) {
+            uint32_t split[4][MAX_SPLIT_BUCKETS] = {};
+            const __m256i zero = _mm256_setzero_si256(), vtop = _mm256_set1_epi32(top);
+            const __m256i vwidth = _mm256_set1_epi32(width), vwidthLess1 = _mm256_set1_epi32(width - 1);
+            const __m256 inverse = _mm256_set1_ps(1.0f / width);
+            alignas(32) int32_t index[8];
+            for (; i + 8 <= n; i += 8) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                x = _mm256_min_epi32(_mm256_max_epi32(x, zero), vtop);
+                __m256i q = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(x), inverse));
+                __m256i low = _mm256_mullo_epi32(q, vwidth);
+                q = _mm256_add_epi32(q, _mm256_cmpgt_epi32(low, x));                              // q too big: -1
+                q = _mm256_sub_epi32(q, _mm256_cmpgt_epi32(x, _mm256_add_epi32(low, vwidthLess1))); // too small: +1
+                _mm256_store_si256(reinterpret_cast<__m256i*>(index), q);
+                for (int k = 0; k < 8; k++) split[k & 3][index[k]]++;
+            }
+            for (size_t b = 0; b < buckets; b++) counts[b] += split[0][b] + split[1][b] + split[2][b] + split[3][b];
+        }
+#endif
+        for (; i < n; i++) counts[min(max(values[i], 0), top) / width]++;
     }
-   
-    static TodoItem deserialize(const string& data) {
-        stringstream ss(data);
-        string item;
-        vector<string> parts;
-       
-        while (getline(ss, item, '|')) parts.push_back(item);
-       
-        if (parts.size() >= 5) {
-            return TodoItem(stoi(parts[0]), parts[1], stoi(parts[3]),
-                          stoll(parts[4]), parts.size() > 5 ? parts[5] : "", parts[2] == "1");
+
+    // Adds values[i] to totals[keys[i]] for every row whose start lies in [from, to).
+    // One pass for all keys; totals must have room for every key.
+    inline void groupedSum(const int32_t* values, const uint32_t* keys, const int64_t* starts, size_t n,
+                           int64_t from, int64_t to, int64_t* totals) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        // The range test runs 8 rows at a time and leaves a bit per row; blocks wholly outside
+        // the window (most of them, since starts are nearly sorted) cost no scatter at all.
+        // SSE2 has no 64-bit compare, so it keeps the scalar loop.
+        const __m256i vfrom = _mm256_set1_epi64x(from), vto = _mm256_set1_epi64x(to);
+        for (; i + 8 <= n; i += 8) {
+            __m256i lowStarts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + i));
+            __m256i highStarts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + i + 4));
+            __m256i lowIn = _mm256_andnot_si256(_mm256_cmpgt_epi64(vfrom, lowStarts), _mm256_cmpgt_epi64(vto, lowStarts));
+            __m256i highIn = _mm256_andnot_si256(_mm256_cmpgt_epi64(vfrom, highStarts), _mm256_cmpgt_epi64(vto, highStarts));
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(lowIn)) | _mm256_movemask_pd(_mm256_castsi256_pd(highIn)) << 4;
+            if (mask == 0) continue;
+            for (int k = 0; k < 8; k++)
+                if (mask >> k & 1) totals[keys[i + k]] += values[i + k];
         }
-        return TodoItem(0, "Unknown task");
+#endif
+        for (; i < n; i++)
+            if (starts[i] >= from && starts[i] < to) totals[keys[i]] += values[i];
     }
-};
+}
 
-// ==================== TODOLIST CLASS ====================
-class TodoList {
+// -------------------- MAPPED FILE (read-only mmap) --------------------
+class MappedFile {
 private:
-    vector<TodoItem> items;
-    int nextId;
+    char* mapped;
+    size_t length;
 
 public:
-    TodoList() : nextId(1) {}
-   
-    void addItem(const string& description, int priority = 2,
-                time_t dueDate = 0, const string& subject = "") {
-        items.push_back(TodoItem(nextId++, description, priority, dueDate, subject));
-    }
-   
-    bool removeItem(int id) {
-        auto it = find_if(items.begin(), items.end(),
-                             [id](const TodoItem& item) { return item.getId() == id; });
-        if (it != items.end()) {
-            items.erase(it);
-            return true;
+    MappedFile() : mapped(nullptr), length(0) {}
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& filename) {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
         }
-        return false;
+        void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);   // the mapping keeps the file referenced
+        if (addr == MAP_FAILED) return false;
+        mapped = static_cast<char*>(addr);
+        length = info.st_size;
+        return true;
     }
-   
-    bool markAsCompleted(int id, bool status = true) {
-        for (auto& item : items) {
-            if (item.getId() == id) {
-                item.setCompleted(status);
-                return true;
-            }
-        }
-        return false;
+
+    void close() {
+        if (mapped) munmap(mapped, length);
+        mapped = nullptr;
+        length = 0;
     }
-   
-    const vector<TodoItem>& getAllItems() const { return items; }
-   
-    vector<TodoItem> getIncompleteItems() const {
-        vector<TodoItem> result;
-        for (const auto& item : items)
-            if (!item.isCompleted()) result.push_back(item);
-        return result;
+
+    bool isOpen() const { return mapped != nullptr; }
+    const char* data() const { return mapped; }
+    size_t size() const { return length; }
+};
+
+// -------------------- SESSION TABLE (columnar, in memory) --------------------
+// One contiguous array per field so scans only touch the columns they read; notes,
+// image paths and file lists live in separate cold columns. Rows are displayed
+// through SessionView without being copied out.
+class SessionTable {
+public:
+    vector<int64_t> start;
+    vector<int64_t> end;
+    vector<int32_t> id;
+    vector<int32_t> duration;
+    vector<int32_t> breakTime;
+    vector<SubjectId> subject;
+    vector<string> notes;
+    vector<string> image;
+    vector<vector<string>> files;
+    // Wall-clock milliseconds from the live timer: start, pause/resume pairs, end.
+    // Empty for sessions ended without it.
+    vector<vector<int64_t>> timeline;
+    static constexpr int32_t MAX_TIMELINE = 1 << 16;   // marks accepted from a journal record
+    // Session id -> row, so replaying a journal doesn't rescan the table per record.
+    // A repeated id maps to its newest row.
+    unordered_map<int32_t, size_t> rowOf;
+
+    size_t size() const { return id.size(); }
+
+    void clear() {
+        start.clear(); end.clear(); id.clear(); duration.clear(); breakTime.clear();
+        subject.clear(); notes.clear(); image.clear(); files.clear(); timeline.clear();
+        rowOf.clear();
     }
-   
-    vector<TodoItem> getItemsSortedByPriority() const {
-        vector<TodoItem> result = items;
-        sort(result.begin(), result.end(),
-                [](const TodoItem& a, const TodoItem& b) {
-                    return a.getPriority() < b.getPriority();
-                });
-        return result;
+
+    // Rebuilds rowOf after the id column was filled in bulk
+    void indexIds() {
+        rowOf.clear();
+        rowOf.reserve(id.size());
+        for (size_t row = 0; row < id.size(); row++) rowOf[id[row]] = row;
     }
-   
-    vector<TodoItem> getItemsSortedByDueDate() const {
-        vector<TodoItem> result = items;
-        sort(result.begin(), result.end(),
-                [](const TodoItem& a, const TodoItem& b) {
-                    if (a.getDueDate() == 0) return false;
-                    if (b.getDueDate() == 0) return true;
-                    return a.getDueDate() < b.getDueDate();
-                });
-        return result;
+
+    void reserve(size_t rows) {
+        start.reserve(rows); end.reserve(rows); id.reserve(rows); duration.reserve(rows);
+        breakTime.reserve(rows); subject.reserve(rows); notes.reserve(rows); image.reserve(rows);
+        files.reserve(rows); timeline.reserve(rows); rowOf.reserve(rows);
     }
-   
-    bool saveToFile(const string& filename) const {
-        ofstream file(filename);
-        if (!file.is_open()) return false;
-        for (const auto& item : items) file << item.serialize() << endl;
-        return true;
+
+    size_t append(int sessionId, SubjectId subjectId, time_t startTime, time_t endTime,
+                  const string& sessionNotes = "", int breakSeconds = 0) {
+        start.push_back(startTime);
+        end.push_back(endTime);
+        id.push_back(sessionId);
+        duration.push_back(difftime(endTime, startTime) - breakSeconds);
+        breakTime.push_back(breakSeconds);
+        subject.push_back(subjectId);
+        notes.push_back(sessionNotes);
+        image.emplace_back();
+        files.emplace_back();
+        timeline.emplace_back();
+        rowOf[sessionId] = size() - 1;
+        return size() - 1;
     }
-   
-    bool loadFromFile(const string& filename) {
-        ifstream file(filename);
-        if (!file.is_open()) return false;
-       
-        items.clear();
-        nextId = 1;
-       
-        string line;
-        while (getline(file, line)) {
-            if (!line.empty()) {
-                TodoItem item = TodoItem::deserialize(line);
-                items.push_back(item);
-                if (item.getId() >= nextId) nextId = item.getId() + 1;
-            }
-        }
-        return true;
+
+    size_t append(const StudySession& session) {
+        size_t row = append(session.getId(), session.getSubjectId(), session.getStartTime(),
+                            session.getEndTime(), session.getNotes(), session.getBreakTime());
+        image[row] = session.getAttachedImage();
+        files[row] = session.getAttachedFiles();
+        return row;
+    }
+
+    void setEnd(size_t row, time_t endTime, int breakSeconds) {
+        end[row] = endTime;
+        breakTime[row] = breakSeconds;
+        duration[row] = difftime(endTime, start[row]) - breakSeconds;
+    }
+
+    // The columns without the id index, for a snapshot that is encoded off-thread
+    SessionTable columnsCopy() const {
+        SessionTable copy;
+        copy.start = start; copy.end = end; copy.id = id; copy.duration = duration;
+        copy.breakTime = breakTime; copy.subject = subject; copy.notes = notes; copy.image = image;
+        copy.files = files; copy.timeline = timeline;
+        return copy;
+    }
+
+    // Row holding a session id, or -1
+    long find(int sessionId) const {
+        auto it = rowOf.find(sessionId);
+        return it == rowOf.end() ? -1 : static_cast<long>(it->second);
     }
 };
 
-// ==================== USER CLASS ====================
-class User {
+// -------------------- SESSION QUERIES --------------------
+// Filters for User::querySessions; unset fields match every session
+struct SessionQuery {
+    enum class Order { NewestFirst, OldestFirst, LongestFirst };
+
+    optional<string> subject;
+    time_t from = numeric_limits<time_t>::min();   // start time in [from, to)
+    time_t to = numeric_limits<time_t>::max();
+    optional<int> minDuration;
+    bool withAttachments = false;                   // only sessions with an image or files
+    Order order = Order::NewestFirst;
+    size_t offset = 0;
+    size_t limit = numeric_limits<size_t>::max();
+};
+
+// One row of the session table, read in place. Rows are never removed, so a view
+// stays valid until the user's history is reloaded.
+class SessionView {
 private:
-    int id;
-    string username;
-    string password;
-    string fullName;
-    vector<StudySession> sessions;
-    TodoList todoList;
-    int nextSessionId;
+    const SessionTable* table;
+    const SubjectDictionary* subjects;
+    size_t row;
 
 public:
-    User(int id, const string& username, const string& password, const string& fullName = "")
-        : id(id), username(username), password(password), fullName(fullName), nextSessionId(1) {}
-   
-    int getId() const { return id; }
-    string getUsername() const { return username; }
-    string getFullName() const { return fullName; }
-    bool verifyPassword(const string& pwd) const { return password == pwd; }
-   
-    int startSession(const string& subject, time_t startTime, const string& notes = "") {
-        sessions.push_back(StudySession(nextSessionId, subject, startTime, time(nullptr), notes));
-        return nextSessionId++;
+    SessionView(const SessionTable& table, const SubjectDictionary& subjects, size_t row)
+        : table(&table), subjects(&subjects), row(row) {}
+
+    int getId() const { return table->id[row]; }
+    SubjectId getSubjectId() const { return table->subject[row]; }
+    const string& getSubject() const { return subjects->name(table->subject[row]); }
+    time_t getStartTime() const { return table->start[row]; }
+    time_t getEndTime() const { return table->end[row]; }
+    int getDuration() const { return table->duration[row]; }
+    int getBreakTime() const { return table->breakTime[row]; }
+    const string& getNotes() const { return table->notes[row]; }
+    const string& getAttachedImage() const { return table->image[row]; }
+    const vector<string>& getAttachedFiles() const { return table->files[row]; }
+    bool hasAttachments() const { return !table->image[row].empty() || !table->files[row].empty(); }
+    const vector<int64_t>& getTimeline() const { return table->timeline[row]; }
+
+    void describe(TextBuffer& out) const {
+        StudySession::describe(out, getId(), getSubject(), getStartTime(), getEndTime(), getDuration(),
+                               getBreakTime(), getNotes(), !getAttachedImage().empty(),
+                               getAttachedFiles().size());
+    }
+
+    string toString() const {
+        TextBuffer out;
+        describe(out);
+        return out.str();
+    }
+};
+
+// Secondary indexes over a SessionTable: all rows ordered by start time, plus one
+// posting list per SubjectId in the same order. Sessions are nearly always added
+// in start order, so keeping the lists sorted is usually a push_back.
+class SessionIndex {
+public:
+    struct Range {
+        const uint32_t* first = nullptr;
+        const uint32_t* last = nullptr;
+        size_t size() const { return last - first; }
+    };
+
+private:
+    vector<uint32_t> byStart;
+    vector<vector<uint32_t>> bySubject;
+
+    static void insert(vector<uint32_t>& rows, const SessionTable& table, uint32_t row) {
+        const vector<int64_t>& start = table.start;
+        if (rows.empty() || start[rows.back()] <= start[row]) {
+            rows.push_back(row);
+            return;
+        }
+        auto at = upper_bound(rows.begin(), rows.end(), start[row],
+                              [&start](int64_t t, uint32_t r) { return t < start[r]; });
+        rows.insert(at, row);
+    }
+
+public:
+    void clear() {
+        byStart.clear();
+        bySubject.clear();
+    }
+
+    void add(const SessionTable& table, size_t row) {
+        SubjectId subject = table.subject[row];
+        if (subject >= bySubject.size()) bySubject.resize(subject + 1);
+        insert(byStart, table, row);
+        insert(bySubject[subject], table, row);
+    }
+
+    void rebuild(const SessionTable& table) {
+        clear();
+        byStart.resize(table.size());
+        for (uint32_t row = 0; row < byStart.size(); row++) byStart[row] = row;
+        const vector<int64_t>& start = table.start;
+        stable_sort(byStart.begin(), byStart.end(),
+                    [&start](uint32_t a, uint32_t b) { return start[a] < start[b]; });
+        // Walking byStart keeps every posting list sorted without a second sort
+        for (uint32_t row : byStart) {
+            SubjectId subject = table.subject[row];
+            if (subject >= bySubject.size()) bySubject.resize(subject + 1);
+            bySubject[subject].push_back(row);
+        }
+    }
+
+    // Rows starting in [from, to), oldest first; `subject` narrows to one posting list
+    Range range(const SessionTable& table, optional<SubjectId> subject, time_t from, time_t to) const {
+        static const vector<uint32_t> none;
+        const vector<uint32_t>& rows = !subject ? byStart
+                                     : *subject < bySubject.size() ? bySubject[*subject] : none;
+        const vector<int64_t>& start = table.start;
+        auto first = lower_bound(rows.begin(), rows.end(), from,
+                                 [&start](uint32_t r, int64_t t) { return start[r] < t; });
+        auto last = lower_bound(first, rows.end(), to,
+                                [&start](uint32_t r, int64_t t) { return start[r] < t; });
+        Range result;
+        result.first = rows.data() + (first - rows.begin());
+        result.last = rows.data() + (last - rows.begin());
+        return result;
+    }
+};
+
+// -------------------- SESSION STORE (binary sessions.dat) --------------------
+// Layout: header | start[] end[] | id[] duration[] break[] | subject[] notes[] image[]
+//         | firstFile[] fileCount[] timeline[] | fileRefs[] | string heap
+//         | blockCrc[] | trailer
+// Every column is rowCount entries wide, strings are (offset, length) into the heap.
+// Since version 4 each row's timeline is a packed int64 array in the heap as well.
+// Since version 2 the image is followed by a CRC32C per 64 KiB block, so a damaged
+// checkpoint is rejected on load. Version 1 images (no trailer) are still accepted,
+// and files written by older versions as pipe-delimited text are still read.
+class SessionStore {
+public:
+    static constexpr char MAGIC[4] = {'S', 'S', 'T', 'B'};
+    static constexpr char TRAILER_MAGIC[4] = {'S', 'S', 'C', 'K'};
+    static constexpr uint32_t VERSION = 4;
+    static constexpr uint32_t CRC_BLOCK_SIZE = 64 * 1024;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t rowCount;
+        int32_t nextSessionId;
+        uint32_t fileRefCount;
+        uint32_t subjectCount;   // v3: entries in the subject table (was reserved)
+        uint64_t heapSize;
+    };
+
+    struct StrRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Trailer {
+        uint32_t blockSize;
+        uint32_t blockCount;
+        uint32_t blockCrcsCrc;   // guards the CRC table itself
+        char magic[4];
+    };
+
+    // Column pointers into a file image; nothing is copied until decode()
+    struct Columns {
+        const Header* header = nullptr;
+        const int64_t* start = nullptr;
+        const int64_t* end = nullptr;
+        const int32_t* id = nullptr;
+        const int32_t* duration = nullptr;
+        const int32_t* breakTime = nullptr;
+        const StrRef* subject = nullptr;          // v1/v2: one string per row
+        const uint32_t* subjectCode = nullptr;    // v3: index into subjectTable per row
+        const StrRef* subjectTable = nullptr;
+        const StrRef* notes = nullptr;
+        const StrRef* image = nullptr;
+        const uint32_t* firstFile = nullptr;
+        const uint32_t* fileCount = nullptr;
+        const StrRef* timeline = nullptr;         // v4
+        const StrRef* fileRefs = nullptr;
+        const char* heap = nullptr;
+
+        uint32_t rows() const { return header ? header->rowCount : 0; }
+
+        string str(const StrRef& ref) const { return string(heap + ref.offset, ref.length); }
+        string_view view(const StrRef& ref) const { return string_view(heap + ref.offset, ref.length); }
+
+        string_view subjectName(uint32_t row) const {
+            return view(subjectCode ? subjectTable[subjectCode[row]] : subject[row]);
+        }
+
+        // Copies every row into a SessionTable; numeric columns go across in bulk
+        void decode(SessionTable& table, SubjectDictionary& subjects) const {
+            uint32_t n = rows();
+            table.clear();
+            table.start.assign(start, start + n);
+            table.end.assign(end, end + n);
+            table.id.assign(id, id + n);
+            table.indexIds();
+            table.duration.assign(duration, duration + n);
+            table.breakTime.assign(breakTime, breakTime + n);
+
+            table.subject.resize(n);
+            if (subjectCode) {
+                vector<SubjectId> remap(header->subjectCount);
+                for (uint32_t code = 0; code < remap.size(); code++) remap[code] = subjects.intern(view(subjectTable[code]));
+                for (uint32_t i = 0; i < n; i++) table.subject[i] = remap[subjectCode[i]];
+            } else {
+                for (uint32_t i = 0; i < n; i++) table.subject[i] = subjects.intern(view(subject[i]));
+            }
+
+            table.notes.resize(n);
+            table.image.resize(n);
+            table.files.resize(n);
+            table.timeline.resize(n);
+            for (uint32_t i = 0; i < n; i++) {
+                table.notes[i] = str(notes[i]);
+                table.image[i] = str(image[i]);
+                for (uint32_t f = 0; f < fileCount[i]; f++) table.files[i].push_back(str(fileRefs[firstFile[i] + f]));
+                if (timeline && timeline[i].length > 0) {
+                    table.timeline[i].resize(timeline[i].length / sizeof(int64_t));
+                    memcpy(table.timeline[i].data(), heap + timeline[i].offset,
+                           table.timeline[i].size() * sizeof(int64_t));
+                }
+            }
+        }
+    };
+
+    // Bytes before the string heap. The counts are 32-bit, so this can't overflow 64 bits.
+    static uint64_t fixedSize(const Header& header) {
+        uint64_t subjectColumn = header.version >= 3 ? sizeof(uint32_t) : sizeof(StrRef);
+        uint64_t rows = header.rowCount, tableRows = header.version >= 3 ? header.subjectCount : 0;
+        uint64_t stringColumns = header.version >= 4 ? 3 : 2;
+        return sizeof(Header) + rows * (2 * sizeof(int64_t) + 3 * sizeof(int32_t) + subjectColumn
+                                        + stringColumns * sizeof(StrRef) + 2 * sizeof(uint32_t))
+               + (header.fileRefCount + tableRows) * sizeof(StrRef);
     }
    
-    bool endSession(int sessionId, time_t endTime, int breakTime = 0) {
-        for (auto& session : sessions) {
-            if (session.getId() == sessionId) {
-                session = StudySession(session.getId(), session.getSubject(),
-                                    session.getStartTime(), endTime, session.getNotes(), breakTime);
-                return true;
+    static size_t imageSize(const Header& header) { return fixedSize(header) + header.heapSize; }
+
+    static bool hasMagic(const char* data, size_t size) {
+        return size >= sizeof(Header) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    static bool isBinaryFile(const string& filename) {
+        ifstream file(filename, ios::binary);
+        char magic[sizeof(MAGIC)] = {};
+        return file.read(magic, sizeof(magic)) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    // Checks the per-block CRCs and returns the size of the image they cover
+    static bool verify(const char* data, size_t size, size_t& imageBytes) {
+        if (size < sizeof(Trailer)) return false;
+        Trailer trailer;
+        memcpy(&trailer, data + size - sizeof(Trailer), sizeof(Trailer));
+        if (memcmp(trailer.magic, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0 || trailer.blockSize == 0) return false;
+        size_t crcBytes = static_cast<size_t>(trailer.blockCount) * sizeof(uint32_t);
+        if (size < sizeof(Trailer) + crcBytes) return false;
+        imageBytes = size - sizeof(Trailer) - crcBytes;
+        if ((imageBytes + trailer.blockSize - 1) / trailer.blockSize != trailer.blockCount) return false;
+
+        const char* crcs = data + imageBytes;
+        if (Checksum::crc32c(crcs, crcBytes) != trailer.blockCrcsCrc) return false;
+        for (uint32_t b = 0; b < trailer.blockCount; b++) {
+            size_t offset = static_cast<size_t>(b) * trailer.blockSize;
+            size_t length = min<size_t>(trailer.blockSize, imageBytes - offset);
+            uint32_t stored;
+            memcpy(&stored, crcs + b * sizeof(uint32_t), sizeof(stored));
+            if (Checksum::crc32c(data + offset, length) != stored) return false;
+        }
+        return true;
+    }
+
+    // Point the columns at a complete file image; fails on a truncated, damaged or foreign image
+    static bool attach(const char* data, size_t size, Columns& cols) {
+        if (!hasMagic(data, size)) return false;
+        const Header* header = reinterpret_cast<const Header*>(data);
+        size_t imageBytes = size;
+        if (header->version >= 2 && header->version <= VERSION) {
+            if (!verify(data, size, imageBytes)) return false;
+        } else if (header->version != 1) {
+            return false;
+        }
+        uint32_t n = header->rowCount;
+        // heapSize is compared with what is left after the fixed columns, never added
+        // to them, so a huge value can't wrap the sum into a match
+        uint64_t fixedBytes = fixedSize(*header);
+        if (fixedBytes > imageBytes || header->heapSize != imageBytes - fixedBytes) return false;
+
+        const char* p = data + sizeof(Header);
+        auto take = [&p](size_t bytes) { const char* at = p; p += bytes; return at; };
+        cols.header = header;
+        cols.start = reinterpret_cast<const int64_t*>(take(n * sizeof(int64_t)));
+        cols.end = reinterpret_cast<const int64_t*>(take(n * sizeof(int64_t)));
+        cols.id = reinterpret_cast<const int32_t*>(take(n * sizeof(int32_t)));
+        cols.duration = reinterpret_cast<const int32_t*>(take(n * sizeof(int32_t)));
+        cols.breakTime = reinterpret_cast<const int32_t*>(take(n * sizeof(int32_t)));
+        if (header->version >= 3) cols.subjectCode = reinterpret_cast<const uint32_t*>(take(n * sizeof(uint32_t)));
+        else cols.subject = reinterpret_cast<const StrRef*>(take(n * sizeof(StrRef)));
+        cols.notes = reinterpret_cast<const StrRef*>(take(n * sizeof(StrRef)));
+        cols.image = reinterpret_cast<const StrRef*>(take(n * sizeof(StrRef)));
+        cols.firstFile = reinterpret_cast<const uint32_t*>(take(n * sizeof(uint32_t)));
+        cols.fileCount = reinterpret_cast<const uint32_t*>(take(n * sizeof(uint32_t)));
+        if (header->version >= 4) cols.timeline = reinterpret_cast<const StrRef*>(take(n * sizeof(StrRef)));
+        cols.fileRefs = reinterpret_cast<const StrRef*>(take(header->fileRefCount * sizeof(StrRef)));
+        if (header->version >= 3)
+            cols.subjectTable = reinterpret_cast<const StrRef*>(take(header->subjectCount * sizeof(StrRef)));
+        cols.heap = take(header->heapSize);
+
+        // Reject codes, string refs and file ranges that point outside the image, so
+        // readers can index unchecked. Version 1 has no CRCs to catch this.
+        uint64_t heapSize = imageBytes - fixedBytes;   // bytes actually mapped after the columns
+        auto inHeap = [heapSize](const StrRef& ref) {
+            return static_cast<uint64_t>(ref.offset) + ref.length <= heapSize;
+        };
+        for (uint32_t i = 0; i < n; i++) {
+            if (cols.subjectCode && cols.subjectCode[i] >= header->subjectCount) return false;
+            if (cols.subject && !inHeap(cols.subject[i])) return false;
+            if (!inHeap(cols.notes[i]) || !inHeap(cols.image[i])) return false;
+            if (static_cast<uint64_t>(cols.firstFile[i]) + cols.fileCount[i] > header->fileRefCount) return false;
+            if (cols.timeline && (cols.timeline[i].length % sizeof(int64_t) != 0 || !inHeap(cols.timeline[i])))
+                return false;
+        }
+        for (uint32_t f = 0; f < header->fileRefCount; f++)
+            if (!inHeap(cols.fileRefs[f])) return false;
+        for (uint32_t s = 0; cols.subjectTable && s < header->subjectCount; s++)
+            if (!inHeap(cols.subjectTable[s])) return false;
+        return true;
+    }
+
+    static vector<char> encode(const SessionTable& sessions, const SubjectDictionary& subjects,
+                               int nextSessionId) {
+        uint32_t n = sessions.size();
+        vector<StrRef> notes(n), image(n), timeline(n), fileRefs, subjectTable;
+        vector<uint32_t> subjectCode(n), firstFile(n), fileCount(n);
+        string heap;
+        // Only subjects that still have sessions go into the file's table
+        const uint32_t NO_CODE = UINT32_MAX;
+        vector<uint32_t> codeOf(subjects.size(), NO_CODE);
+
+        auto intern = [&heap](const string& s) {
+            StrRef ref = {static_cast<uint32_t>(heap.size()), static_cast<uint32_t>(s.size())};
+            heap += s;
+            return ref;
+        };
+
+        // Numeric columns are written straight from the table; only strings need a pass
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t& code = codeOf[sessions.subject[i]];
+            if (code == NO_CODE) {
+                code = subjectTable.size();
+                subjectTable.push_back(intern(subjects.name(sessions.subject[i])));
             }
+            subjectCode[i] = code;
+            notes[i] = intern(sessions.notes[i]);
+            image[i] = intern(sessions.image[i]);
+
+            firstFile[i] = fileRefs.size();
+            fileCount[i] = sessions.files[i].size();
+            for (const auto& f : sessions.files[i]) fileRefs.push_back(intern(f));
+
+            const vector<int64_t>& marks = sessions.timeline[i];
+            timeline[i] = {static_cast<uint32_t>(heap.size()), static_cast<uint32_t>(marks.size() * sizeof(int64_t))};
+            heap.append(reinterpret_cast<const char*>(marks.data()), marks.size() * sizeof(int64_t));
+        }
+
+        Header header = {};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.rowCount = n;
+        header.nextSessionId = nextSessionId;
+        header.fileRefCount = fileRefs.size();
+        header.subjectCount = subjectTable.size();
+        header.heapSize = heap.size();
+
+        vector<char> out;
+        out.reserve(imageSize(header) + sizeof(Trailer));
+        auto put = [&out](const void* src, size_t bytes) {
+            const char* c = static_cast<const char*>(src);
+            out.insert(out.end(), c, c + bytes);
+        };
+        put(&header, sizeof(header));
+        put(sessions.start.data(), n * sizeof(int64_t));
+        put(sessions.end.data(), n * sizeof(int64_t));
+        put(sessions.id.data(), n * sizeof(int32_t));
+        put(sessions.duration.data(), n * sizeof(int32_t));
+        put(sessions.breakTime.data(), n * sizeof(int32_t));
+        put(subjectCode.data(), n * sizeof(uint32_t));
+        put(notes.data(), n * sizeof(StrRef));
+        put(image.data(), n * sizeof(StrRef));
+        put(firstFile.data(), n * sizeof(uint32_t));
+        put(fileCount.data(), n * sizeof(uint32_t));
+        put(timeline.data(), n * sizeof(StrRef));
+        put(fileRefs.data(), fileRefs.size() * sizeof(StrRef));
+        put(subjectTable.data(), subjectTable.size() * sizeof(StrRef));
+        put(heap.data(), heap.size());
+
+        Trailer trailer = {};
+        trailer.blockSize = CRC_BLOCK_SIZE;
+        trailer.blockCount = (out.size() + CRC_BLOCK_SIZE - 1) / CRC_BLOCK_SIZE;
+        vector<uint32_t> blockCrcs(trailer.blockCount);
+        for (uint32_t b = 0; b < trailer.blockCount; b++) {
+            size_t offset = static_cast<size_t>(b) * CRC_BLOCK_SIZE;
+            blockCrcs[b] = Checksum::crc32c(out.data() + offset, min<size_t>(CRC_BLOCK_SIZE, out.size() - offset));
         }
+        trailer.blockCrcsCrc = Checksum::crc32c(blockCrcs.data(), blockCrcs.size() * sizeof(uint32_t));
+        memcpy(trailer.magic, TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+        put(blockCrcs.data(), blockCrcs.size() * sizeof(uint32_t));
+        put(&trailer, sizeof(trailer));
+        return out;
+    }
+
+    static bool write(const string& filename, const SessionTable& sessions,
+                      const SubjectDictionary& subjects, int nextSessionId) {
+        return writeImage(filename, encode(sessions, subjects, nextSessionId));
+    }
+
+    static bool writeImage(const string& filename, const vector<char>& image) {
+        return Checkpoint::writeFile(filename, image.data(), image.size());
+    }
+
+    // Maps the file instead of reading it; rows are decoded later via cols.decode()
+    static bool mapFile(const string& filename, MappedFile& file, Columns& cols) {
+        if (!file.open(filename)) return false;
+        if (attach(file.data(), file.size(), cols)) return true;
+        file.close();
+        cols = Columns();
         return false;
     }
-   
-    StudySession* getSession(int sessionId) {
-        for (auto& session : sessions)
-            if (session.getId() == sessionId) return &session;
-        return nullptr;
+
+    // Reads the whole file with one read. Returns false (leaving outputs untouched)
+    // when the file is missing or not in the binary format.
+    static bool read(const string& filename, SessionTable& sessions, SubjectDictionary& subjects,
+                     int& nextSessionId) {
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file.is_open()) return false;
+        streamsize size = file.tellg();
+        if (size < static_cast<streamsize>(sizeof(Header))) return false;
+
+        // uint64_t storage keeps the column pointers naturally aligned
+        vector<uint64_t> buffer((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        char* data = reinterpret_cast<char*>(buffer.data());
+        file.seekg(0);
+        if (!file.read(data, size)) return false;
+
+        Columns cols;
+        if (!attach(data, size, cols)) return false;
+
+        cols.decode(sessions, subjects);
+        nextSessionId = cols.header->nextSessionId;
+        return true;
     }
+};
+
+// -------------------- TODOITEM CLASS ------------------------------
+class TodoItem {
+private:
+    int id;
+    string description;
+    bool completed;
+    int priority;
+    time_t dueDate;
+    const SubjectDictionary* subjects;
+    SubjectId subjectId;
+
+public:
+    TodoItem(SubjectDictionary& subjects, int id, const string& desc, int priority = 2,
+           time_t dueDate = 0, string_view subject = "", bool completed = false)
+        : id(id), description(desc), completed(completed), priority(priority), dueDate(dueDate),
+          subjects(&subjects), subjectId(subjects.intern(subject)) {}
    
-    vector<StudySession> getAllSessions() const { return sessions; }
+    int getId() const { return id; }
+    const string& getDescription() const { return description; }
+    bool isCompleted() const { return completed; }
+    int getPriority() const { return priority; }
+    time_t getDueDate() const { return dueDate; }
+    SubjectId getSubjectId() const { return subjectId; }
+    const string& getSubject() const { return subjects->name(subjectId); }
+    void setCompleted(bool status) { completed = status; }
    
-    map<string, int> getTimePerSubject() const {
-        map<string, int> result;
-        for (const auto& session : sessions) {
-            string subject = session.getSubject();
-            if (result.find(subject) == result.end()) result[subject] = session.getDuration();
-            else result[subject] += session.getDuration();
+    string getPriorityString() const {
+        switch (priority) {
+            case 1: return "High";
+            case 2: return "Medium";
+            case 3: return "Low";
+            default: return "Unknown";
         }
-        return result;
     }
    
-    int getTotalStudyTime() const {
-        int total = 0;
-        for (const auto& session : sessions) total += session.getDuration();
-        return total;
+    void describe(TextBuffer& out) const {
+        out << '[' << (completed ? 'X' : ' ') << "] " << description;
+        if (subjectId != SubjectDictionary::NONE) out << " (" << getSubject() << ')';
+        out << " - Priority: " << getPriorityString();
+        if (dueDate > 0) {
+            out << ", Due: ";
+            out.date(dueDate);
+        }
     }
    
-    TodoList& getTodoList() { return todoList; }
-    const TodoList& getTodoList() const { return todoList; }
+    string toString() const {
+        TextBuffer out;
+        describe(out);
+        return out.str();
+    }
    
-    bool saveUserData(const string& sessionFile, const string& todoFile) const {
-        ofstream sessionOut(sessionFile);
-        if (!sessionOut.is_open()) return false;
-       
-        for (const auto& session : sessions) sessionOut << session.serialize() << endl;
-        sessionOut << "NEXT_ID=" << nextSessionId << endl;
-        sessionOut.close();
-       
-        return todoList.saveToFile(todoFile);
+    string serialize() const {
+        stringstream ss;
+        ss << id << "|" << description << "|" << (completed ? "1" : "0") << "|"
+           << priority << "|" << dueDate << "|" << getSubject();
+        return ss.str();
     }
    
-    bool loadUserData(const string& sessionFile, const string& todoFile) {
-        ifstream sessionIn(sessionFile);
-        if (sessionIn.is_open()) {
-            sessions.clear();
-            nextSessionId = 1;
-           
-            string line;
-            while (getline(sessionIn, line)) {
-                if (line.substr(0, 8) == "NEXT_ID=") nextSessionId = stoi(line.substr(8));
-                else if (!line.empty()) sessions.push_back(StudySession::deserialize(line));
-            }
-            sessionIn.close();
+    static TodoItem fromRecord(const TextScan::Record& parts, SubjectDictionary& subjects) {
+        if (parts.count >= 5) {
+            return TodoItem(subjects, TextScan::toNumber<int>(parts[0]), string(parts[1]), TextScan::toNumber<int>(parts[3]),
+                          TextScan::toNumber<time_t>(parts[4]), parts[5], parts[2] == "1");
         }
-        return todoList.loadFromFile(todoFile);
+        return TodoItem(subjects, 0, "Unknown task");
     }
    
+    static TodoItem deserialize(const string& data, SubjectDictionary& subjects) {
+        TextScan::LineScanner scanner(data.data(), data.size());
+        TextScan::Record record;
+        scanner.next(record);
+        return fromRecord(record, subjects);
+    }
 };
-User* currentUser = nullptr;
-class FileUploader {
+
+// Todo items in the order of one TodoList index, read in place; valid until the list changes
+class TodoView {
+public:
+    using Index = map<pair<int64_t, int>, uint32_t>;   // (sort key, id) -> slot
+   
+    class iterator {
+    private:
+        Index::const_iterator at;
+        const vector<TodoItem>* items;
+       
+    public:
+        iterator(Index::const_iterator at, const vector<TodoItem>* items) : at(at), items(items) {}
+        const TodoItem& operator*() const { return (*items)[at->second]; }
+        const TodoItem* operator->() const { return &(*items)[at->second]; }
+        iterator& operator++() { ++at; return *this; }
+        bool operator==(const iterator& other) const { return at == other.at; }
+        bool operator!=(const iterator& other) const { return at != other.at; }
+    };
+   
 private:
-    string uploadDir;
+    const Index* index;
+    const vector<TodoItem>* items;
    
 public:
-    FileUploader(const string& dir = "uploads") : uploadDir(dir) {
-        // to create upload directory when the file does not exist
-        fs::create_directories(uploadDir);
+    TodoView(const Index& index, const vector<TodoItem>& items) : index(&index), items(&items) {}
+    iterator begin() const { return iterator(index->begin(), items); }
+    iterator end() const { return iterator(index->end(), items); }
+    size_t size() const { return index->size(); }
+    bool empty() const { return index->empty(); }
+};
+
+// ==================== TODOLIST CLASS ====================
+// Items live in slots that removals free for reuse. An id -> slot hash gives O(1)
+// lookups, and ordered indexes keep the id, priority, due-date and open-item
+// orders current on every change, so listing never copies or sorts.
+class TodoList {
+private:
+    vector<TodoItem> items;   // slots; a freed slot keeps its stale item until reused
+    vector<uint32_t> freeSlots;
+    unordered_map<int, uint32_t> slotOf;
+    TodoView::Index byId, byPriority, byDueDate, open;   // byId and open use a sort key of 0
+    int nextId;
+    SubjectDictionary& subjects;
+   
+    // Undated items sort after every dated one
+    static int64_t dueKey(const TodoItem& item) {
+        return item.getDueDate() == 0 ? numeric_limits<int64_t>::max() : item.getDueDate();
     }
    
-    bool uploadFile(const string& sourcePath, const string& destFilename, string& outPath) {
-        if (!fs::exists(sourcePath)) {
-            cerr << "Source file does not exist: " << sourcePath << endl;
-            return false;
-        }
-       
-        // Create user specific directory
-        string userDir = uploadDir + "/" + to_string(currentUser->getId());
-        fs::create_directories(userDir);
-       
-        // Generate destination path
-        string destPath = userDir + "/" + destFilename;
-       
-        try {
-            // Copy of the file
-            fs::copy_file(sourcePath, destPath, fs::copy_options::overwrite_existing);
-            outPath = destPath;
-            return true;
-        } catch (const fs::filesystem_error& e) {
-            cerr << "Error copying file: " << e.what() << endl;
-            return false;
+    void insert(const TodoItem& item) {
+        uint32_t slot;
+        if (freeSlots.empty()) {
+            slot = items.size();
+            items.push_back(item);
+        } else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            items[slot] = item;
         }
+        int id = item.getId();
+        slotOf[id] = slot;
+        byId[{0, id}] = slot;
+        byPriority[{item.getPriority(), id}] = slot;
+        byDueDate[{dueKey(item), id}] = slot;
+        if (!item.isCompleted()) open[{0, id}] = slot;
+        if (id >= nextId) nextId = id + 1;
     }
+
+public:
+    explicit TodoList(SubjectDictionary& subjects) : nextId(1), subjects(subjects) {}
    
-};
-//----------------SDL FUNCTIONS--------------------
-void renderText(SDL_Renderer* renderer, TTF_Font* font, const string& text, int x, int y, SDL_Color color, bool centered = false) {
-    if (!font || text.empty()) return;
+    int addItem(const string& description, int priority = 2,
+                time_t dueDate = 0, const string& subject = "") {
+        int id = nextId;
+        insert(TodoItem(subjects, id, description, priority, dueDate, subject));
+        return id;
+    }
    
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), color);
-    if (!surface) return;
+    // Re-insert an item with its original id (journal replay); ignored if the id exists
+    bool restoreItem(const TodoItem& item) {
+        if (slotOf.count(item.getId())) return false;
+        insert(item);
+        return true;
+    }
    
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!texture) {
-        SDL_FreeSurface(surface);
-        return;
+    const TodoItem* getItem(int id) const {
+        auto it = slotOf.find(id);
+        return it == slotOf.end() ? nullptr : &items[it->second];
     }
    
-    SDL_Rect rect;
-    rect.w = surface->w;
-    rect.h = surface->h;
+    bool removeItem(int id) {
+        auto it = slotOf.find(id);
+        if (it == slotOf.end()) return false;
+        const TodoItem& item = items[it->second];
+        byId.erase({0, id});
+        byPriority.erase({item.getPriority(), id});
+        byDueDate.erase({dueKey(item), id});
+        open.erase({0, id});
+        freeSlots.push_back(it->second);
+        slotOf.erase(it);
+        return true;
+    }
    
-    if (centered) {
-        rect.x = x - rect.w / 2;
-        rect.y = y - rect.h / 2;
-    } else {
-        rect.x = x;
-        rect.y = y;
+    bool markAsCompleted(int id, bool status = true) {
+        auto it = slotOf.find(id);
+        if (it == slotOf.end()) return false;
+        items[it->second].setCompleted(status);
+        if (status) open.erase({0, id});
+        else open[{0, id}] = it->second;
+        return true;
     }
    
-    SDL_RenderCopy(renderer, texture, NULL, &rect);
+    size_t size() const { return slotOf.size(); }
    
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-}
-
-// ==================== SDL PIE CHART CLASS ====================
-class SDLPieChart {
-private:
-    SDL_Renderer* renderer;
-    TTF_Font* font;
-    int centerX, centerY;
-    int radius;
-    string title;
-    vector<pair<string, int>> data;
-    vector<SDL_Color> colors;
+    // Views in id order (the order items were added), by priority, by due date
+    // (undated last) and of incomplete items only; ties fall back to id order
+    TodoView getAllItems() const { return TodoView(byId, items); }
+    TodoView getIncompleteItems() const { return TodoView(open, items); }
+    TodoView getItemsSortedByPriority() const { return TodoView(byPriority, items); }
+    TodoView getItemsSortedByDueDate() const { return TodoView(byDueDate, items); }
    
-    // Convert degrees to radians
-    float degToRad(float degrees) const {
-        return degrees * M_PI / 180.0f;
+    string serializeAll() const {
+        string text;
+        for (const auto& item : getAllItems()) text += item.serialize() + "\n";
+        return text;
     }
    
-    //To  Draw the pie slice
-    void drawFilledArc(int x, int y, int radius, float startAngle, float endAngle, SDL_Color color) {
-        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-       
-        //To convert angles to radians
-        float startRad = degToRad(startAngle - 90); // -90 to start at top
-        float endRad = degToRad(endAngle - 90);
-       
-        // Draw filled pie slice using triangles
-        for (float angle = startRad; angle <= endRad; angle += 0.01f) {
-            int x1 = x + static_cast<int>(radius * cos(angle));
-            int y1 = y + static_cast<int>(radius * sin(angle));
-            SDL_RenderDrawLine(renderer, x, y, x1, y1);
+    bool saveToFile(const string& filename) const {
+        string text = Checkpoint::sealText(serializeAll());
+        return Checkpoint::writeFile(filename, text.data(), text.size());
+    }
+   
+    // Falls back to the previous checkpoint when the current one fails its checksum
+    bool loadFromFile(const string& filename) {
+        string text;
+        if (!TextScan::readFile(filename, text)) return false;
+        if (!Checkpoint::unsealText(text)) {
+            cerr << filename << " is damaged, using the previous checkpoint." << endl;
+            if (!TextScan::readFile(Checkpoint::previous(filename), text) || !Checkpoint::unsealText(text))
+                text.clear();
         }
        
-        // To draw outline
-        for (float angle = startRad; angle <= endRad; angle += 0.01f) {
-            int x1 = x + static_cast<int>(radius * cos(angle));
-            int y1 = y + static_cast<int>(radius * sin(angle));
-            SDL_RenderDrawPoint(renderer, x1, y1);
-        }
+        items.clear();
+        freeSlots.clear();
+        slotOf.clear();
+        byId.clear();
+        byPriority.clear();
+        byDueDate.clear();
+        open.clear();
+        nextId = 1;
+       
+        // A repeated id keeps its first line
+        TextScan::LineScanner scanner(text.data(), text.size());
+        TextScan::Record record;
+        while (scanner.next(record)) restoreItem(TodoItem::fromRecord(record, subjects));
+        return true;
+    }
+};
+
+// -------------------- BYTE BUFFERS (journal records) --------------------
+class ByteWriter {
+private:
+    vector<char> buffer;
+
+    void put(const void* src, size_t bytes) {
+        const char* c = static_cast<const char*>(src);
+        buffer.insert(buffer.end(), c, c + bytes);
     }
 
 public:
-    SDLPieChart(SDL_Renderer* renderer, TTF_Font* font, int centerX, int centerY, int radius)
-        : renderer(renderer), font(font), centerX(centerX), centerY(centerY), radius(radius), title("Pie Chart") {
-        // Initialize default colors
-        colors = {
-            {255, 0, 0, 255},     // Red
-            {0, 255, 0, 255},     // Green
-            {0, 0, 255, 255},     // Blue
-            {255, 255, 0, 255},   // Yellow
-            {255, 0, 255, 255},   // Magenta
-            {0, 255, 255, 255},   // Cyan
-            {255, 128, 0, 255},   // Orange
-            {128, 0, 255, 255},   // Purple
-            {0, 128, 255, 255},   // Light blue
-            {128, 255, 0, 255}    // Lime
-        };
+    ByteWriter& u8(uint8_t v) { put(&v, sizeof(v)); return *this; }
+    ByteWriter& i32(int32_t v) { put(&v, sizeof(v)); return *this; }
+    ByteWriter& i64(int64_t v) { put(&v, sizeof(v)); return *this; }
+    ByteWriter& raw(const char* src, size_t bytes) { put(src, bytes); return *this; }
+    ByteWriter& str(const string& s) {
+        i32(static_cast<int32_t>(s.size()));
+        put(s.data(), s.size());
+        return *this;
     }
-    //To  add a data point to the pie chart
-    void addDataPoint(const string& label, int value) {
-        data.push_back(make_pair(label, value));
+    const vector<char>& bytes() const { return buffer; }
+};
+
+// Reads fields back in write order; any overrun clears ok() instead of throwing
+class ByteReader {
+private:
+    const char* pos;
+    const char* end;
+    bool good;
+
+    bool take(void* dst, size_t bytes) {
+        if (!good || static_cast<size_t>(end - pos) < bytes) return good = false;
+        memcpy(dst, pos, bytes);
+        pos += bytes;
+        return true;
     }
-    // Clear all data
-    void clearData() {
-        data.clear();
+
+public:
+    ByteReader(const char* data, size_t size) : pos(data), end(data + size), good(true) {}
+
+    bool ok() const { return good; }
+    const char* skip(int32_t bytes) {
+        if (!good || bytes < 0 || end - pos < bytes) { good = false; return nullptr; }
+        const char* at = pos;
+        pos += bytes;
+        return at;
     }
-   
-    // Set chart title
-    void setTitle(const string& newTitle) {
-        title = newTitle;
+    uint8_t u8() { uint8_t v = 0; take(&v, sizeof(v)); return v; }
+    int32_t i32() { int32_t v = 0; take(&v, sizeof(v)); return v; }
+    int64_t i64() { int64_t v = 0; take(&v, sizeof(v)); return v; }
+    string str() {
+        int32_t len = i32();
+        if (!good || len < 0 || end - pos < len) { good = false; return ""; }
+        string s(pos, len);
+        pos += len;
+        return s;
     }
-   
-    // Render the pie chart
-    void render() {
-        if (data.empty()) return;
-       
-        // Calculate total value
-        int total = 0;
-        for (const auto& pair : data) total += pair.second;
-       
-        // Draw title
-        SDL_Color titleColor = {255, 255, 255, 255};
-        renderText(renderer, font, title, centerX, centerY - radius - 30, titleColor, true);
-       
-        // Draw each slice
-        float currentAngle = 0.0f;
-        for (size_t i = 0; i < data.size(); ++i) {
-            const auto& pair = data[i];
-            SDL_Color color = colors[i % colors.size()];
-           
-            // Calculate angles
-            float sliceAngle = (static_cast<float>(pair.second) / total) * 360.0f;
-            float midAngle = currentAngle + sliceAngle / 2.0f;
-           
-            // To draw the slice
-            drawFilledArc(centerX, centerY, radius, currentAngle, currentAngle + sliceAngle, color);
-           
-            // To calculate label
-            float labelDistance = radius * 1.3f;
-            int labelX = centerX + static_cast<int>(labelDistance * cos(degToRad(midAngle - 90)));
-            int labelY = centerY + static_cast<int>(labelDistance * sin(degToRad(midAngle - 90)));
-           
-            // To Draw label
-            renderText(renderer, font, pair.first, labelX, labelY, color, true);
-           
-            // To draw value and percentage
-            float percentage = (static_cast<float>(pair.second) / total) * 100.0f;
-            string valueText = Utils::formatDuration(pair.second) +
-                                   " (" + to_string(static_cast<int>(percentage)) + "%)";
-           
-            // Draw value text slightly below the label
-            renderText(renderer, font, valueText, labelX, labelY + 20, color, true);
-           
-            // Update current angle for next slice
-            currentAngle += sliceAngle;
+};
+
+// -------------------- PASSWORD HASHING --------------------
+// Accounts are persisted, so only a salted, iterated SHA-256 of the password is stored
+namespace Password {
+    const int ITERATIONS = 10000;
+
+    string sha256(const string& data) {
+        static const uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+        string msg = data;
+        uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+        msg += static_cast<char>(0x80);
+        while (msg.size() % 64 != 56) msg += '\0';
+        for (int i = 7; i >= 0; i--) msg += static_cast<char>((bitLength >> (i * 8)) & 0xff);
+
+        for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++) {
+                const unsigned char* b = reinterpret_cast<const unsigned char*>(&msg[chunk + i * 4]);
+                w[i] = (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | b[3];
+            }
+            for (int i = 16; i < 64; i++) {
+                uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+            for (int i = 0; i < 64; i++) {
+                uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                hh = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+            h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
         }
-       
-        // Draw legend
-        int legendX = centerX + radius + 50;
-        int legendY = centerY - radius;
-        int legendWidth = 200;
-        int legendHeight = data.size() * 25 + 40;
-       
-        // Draw legend background
-        SDL_Rect legendRect = {legendX, legendY, legendWidth, legendHeight};
-        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-        SDL_RenderFillRect(renderer, &legendRect);
-        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-        SDL_RenderDrawRect(renderer, &legendRect);
-       
-        // Draw legend title
-        renderText(renderer, font, "Legend", legendX + legendWidth / 2, legendY + 20, titleColor, true);
-       
-        // Draw legend items
-        for (size_t i = 0; i < data.size(); i++) {
-            const auto& pair = data[i];
-            SDL_Color color = colors[i % colors.size()];
-            int itemY = legendY + 50 + i * 25;
-           
-            // Draw color box
-            SDL_Rect colorRect = {legendX + 20, itemY, 15, 15};
-            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-            SDL_RenderFillRect(renderer, &colorRect);
-           
-            // Draw label and value
-            string legendText = pair.first + ": " + Utils::formatDuration(pair.second);
-            renderText(renderer, font, legendText, legendX + 45, itemY + 7, titleColor, false);
+
+        string digest(32, '\0');
+        for (int i = 0; i < 32; i++) digest[i] = static_cast<char>((h[i / 4] >> (24 - (i % 4) * 8)) & 0xff);
+        return digest;
+    }
+
+    string toHex(const string& bytes) {
+        static const char digits[] = "0123456789abcdef";
+        string out;
+        for (unsigned char c : bytes) {
+            out += digits[c >> 4];
+            out += digits[c & 0x0f];
         }
+        return out;
+    }
+
+    string makeSalt() {
+        random_device rd;
+        string salt(16, '\0');
+        for (auto& c : salt) c = static_cast<char>(rd() & 0xff);
+        return toHex(salt);
+    }
+
+    string hash(const string& salt, const string& password) {
+        string digest = sha256(salt + password);
+        for (int i = 1; i < ITERATIONS; i++) digest = sha256(digest + password);
+        return toHex(digest);
+    }
+
+    // Compares without an early exit so timing does not reveal the matching prefix
+    bool equals(const string& a, const string& b) {
+        if (a.size() != b.size()) return false;
+        unsigned char diff = 0;
+        for (size_t i = 0; i < a.size(); i++) diff |= a[i] ^ b[i];
+        return diff == 0;
     }
+}
+
+enum class JournalOp : uint8_t {
+    SessionStarted = 1,
+    SessionEnded,
+    TodoAdded,
+    TodoCompleted,
+    TodoRemoved,
+    ImageAttached,
+    FileAttached,
+    SessionTimed
 };
 
-// ----------- VISUALIZATION CLASS (to show visulation on terminal only)------
-class Visualization {
-protected:
-    User* user;
-    string content;
-    int width;
-   
-    string getBarSymbol(int value, int maxValue, int maxBars = 50) const {
-        if (maxValue <= 0) return "";
-        int numBars = static_cast<int>((static_cast<double>(value) / maxValue) * maxBars);
-        return string(numBars, '|');
+// -------------------- TIME ROLLUPS (day / week / month) --------------------
+// Study time bucketed by local calendar day, with week (Monday start) and month
+// levels kept alongside. Sessions crossing midnight are split by wall-clock share.
+class StudyRollup {
+public:
+    struct Bucket {
+        int duration = 0;
+        int sessionCount = 0;   // counted on the day a session starts
+    };
+    enum class Level { Day, Week, Month };
+
+private:
+    map<int32_t, Bucket> days, weeks, months;
+
+    // Local day containing t, its month key, and the instant the following day starts
+    static void locate(time_t t, int32_t& day, int32_t& month, time_t& dayEnd) {
+        day = Utils::localDay(t);
+        month = Utils::monthKey(day);
+        dayEnd = max<time_t>(Utils::localMidnight(day + 1), t + 1);
+    }
+
+    static void add(map<int32_t, Bucket>& level, int32_t key, int duration, int sessionCount) {
+        Bucket& bucket = level[key];
+        bucket.duration += duration;
+        bucket.sessionCount += sessionCount;
+        if (bucket.duration == 0 && bucket.sessionCount == 0) level.erase(key);
+    }
+
+    void credit(int32_t day, int32_t month, int duration, int sessionCount) {
+        add(days, day, duration, sessionCount);
+        add(weeks, weekOf(day), duration, sessionCount);
+        add(months, month, duration, sessionCount);
     }
 
 public:
-    Visualization(User* user, int width = 80) : user(user), width(width) {}
-    virtual ~Visualization() {}
-   
-    virtual void render() = 0;
-    string getContent() const { return content; }
-   
-    void saveToFile(const string& filename) {
-        ofstream file(filename);
-        if (file.is_open()) {
-            file << content;
-            file.close();
-            cout << "Visualization saved to " << filename << endl;
+    static int32_t weekOf(int32_t day) { return day - ((day % 7 + 10) % 7); }   // 1970-01-01 was a Thursday
+
+    static int32_t dayOf(time_t t) {
+        int32_t day, month;
+        time_t dayEnd;
+        locate(t, day, month, dayEnd);
+        return day;
+    }
+
+    static int32_t monthOf(time_t t) {
+        int32_t day, month;
+        time_t dayEnd;
+        locate(t, day, month, dayEnd);
+        return month;
+    }
+
+    // Bulk load of whole columns: day keys come from one batch conversion, and
+    // sessions that start and end on the same local day skip the split loop
+    void addAll(const int64_t* start, const int64_t* end, const int32_t* duration, size_t n) {
+        vector<int32_t> startDays(n), endDays(n);
+        Utils::localDays(start, n, startDays.data());
+        Utils::localDays(end, n, endDays.data());
+        for (size_t i = 0; i < n; i++) {
+            if (end[i] <= start[i] || startDays[i] == endDays[i])
+                credit(startDays[i], Utils::monthKey(startDays[i]), duration[i], 1);
+            else apply(start[i], end[i], duration[i]);
+        }
+    }
+
+    // sign = -1 takes a session back out (e.g. before its end time changes)
+    void apply(time_t start, time_t end, int duration, int sign = 1) {
+        int32_t day, month;
+        time_t dayEnd;
+        if (end <= start) {
+            locate(start, day, month, dayEnd);
+            credit(day, month, sign * duration, sign);
+            return;
         }
+        // Each day gets its share of the wall-clock span; the last day takes the rounding remainder
+        long long span = end - start;
+        int remaining = duration;
+        for (time_t t = start; t < end; ) {
+            locate(t, day, month, dayEnd);
+            time_t segmentEnd = min(end, dayEnd);
+            int share = segmentEnd == end ? remaining : static_cast<int>(duration * (segmentEnd - t) / span);
+            remaining -= share;
+            credit(day, month, sign * share, t == start ? sign : 0);
+            t = segmentEnd;
+        }
+    }
+
+    void clear() { days.clear(); weeks.clear(); months.clear(); }
+
+    const map<int32_t, Bucket>& buckets(Level level) const {
+        return level == Level::Day ? days : level == Level::Week ? weeks : months;
+    }
+
+    // Sum of the buckets with keys in [from, to]; touches only those buckets
+    Bucket total(Level level, int32_t from, int32_t to) const {
+        Bucket sum;
+        const map<int32_t, Bucket>& index = buckets(level);
+        for (auto it = index.lower_bound(from); it != index.end() && it->first <= to; ++it) {
+            sum.duration += it->second.duration;
+            sum.sessionCount += it->second.sessionCount;
+        }
+        return sum;
     }
 };
 
-class BarChart : public Visualization {
+// -------------------- QUANTILE SKETCH (KLL) --------------------
+// Approximate quantiles in a few KB no matter how many values go in. Level h holds
+// values that each stand for 2^h originals; a full level is sorted and every other
+// value is promoted. Sketches merge by concatenating levels, so per-user sketches
+// combine into cohort statistics cheaply. Rank error is around 1% with K = 200.
+class QuantileSketch {
 private:
-    string title;
-    vector<pair<string, int>> data;
+    static constexpr size_t K = 200;
+    vector<vector<int32_t>> levels;
+    uint64_t count = 0;
+    uint32_t coin = 0x9e3779b9u;   // xorshift state; picks which half of a level survives
+
+    size_t capacity(size_t level) const {
+        static const array<size_t, 32> byDepth = [] {
+            array<size_t, 32> caps{};
+            for (size_t depth = 0; depth < caps.size(); depth++)
+                caps[depth] = max<size_t>(2, static_cast<size_t>(ceil(K * pow(2.0 / 3.0, depth))));
+            return caps;
+        }();
+        return byDepth[min<size_t>(levels.size() - 1 - level, byDepth.size() - 1)];
+    }
+
+    void compress() {
+        for (size_t h = 0; h < levels.size(); h++) {
+            if (levels[h].size() < capacity(h)) continue;
+            if (h + 1 == levels.size()) levels.emplace_back();
+            vector<int32_t>& items = levels[h];
+            vector<int32_t>& above = levels[h + 1];
+            sort(items.begin(), items.end());
+            coin ^= coin << 13;
+            coin ^= coin >> 17;
+            coin ^= coin << 5;
+            size_t paired = items.size() & ~static_cast<size_t>(1);
+            for (size_t i = coin & 1; i < paired; i += 2) above.push_back(items[i]);
+            items.erase(items.begin(), items.begin() + paired);   // an odd value out stays behind
+        }
+    }
 
 public:
-    BarChart(User* user, const string& title) : Visualization(user, 80), title(title) {}
-   
-    void addDataPoint(const string& label, int value) {
-        data.push_back(make_pair(label, value));
+    QuantileSketch() : levels(1) {}
+
+    void add(int32_t value) {
+        levels[0].push_back(value);
+        count++;
+        if (levels[0].size() >= capacity(0)) compress();
     }
-   
-    void render() override {
-        stringstream ss;
-        int maxValue = 0;
-        for (const auto& pair : data)
-            if (pair.second > maxValue) maxValue = pair.second;
-       
-        ss << "+" << string(width - 2, '-') << "+" << endl;
-        ss << "|" << setw((width - 2 - title.length()) / 2) << " " << title
-           << setw((width - 2 - title.length() + 1) / 2) << " " << "|" << endl;
-        ss << "+" << string(width - 2, '-') << "+" << endl;
-       
-        for (const auto& pair : data) {
-            ss << "| " << left << setw(15) << pair.first.substr(0, 15) << " | "
-               << getBarSymbol(pair.second, maxValue, width - 30) << " "
-               << right << setw(8) << Utils::formatDuration(pair.second) << " |" << endl;
+
+    void merge(const QuantileSketch& other) {
+        if (other.levels.size() > levels.size()) levels.resize(other.levels.size());
+        for (size_t h = 0; h < other.levels.size(); h++)
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+        count += other.count;
+        compress();
+    }
+
+    uint64_t size() const { return count; }
+
+    // Value at quantile q in [0, 1]; 0 for an empty sketch
+    int32_t quantile(double q) const {
+        vector<pair<int32_t, uint64_t>> weighted;
+        uint64_t totalWeight = 0;
+        for (size_t h = 0; h < levels.size(); h++) {
+            for (int32_t value : levels[h]) weighted.emplace_back(value, uint64_t(1) << h);
+            totalWeight += levels[h].size() << h;
         }
-       
-        ss << "+" << string(width - 2, '-') << "+" << endl;
-        content = ss.str();
-        cout << content << endl;
+        if (weighted.empty()) return 0;
+        sort(weighted.begin(), weighted.end());
+        double target = q * totalWeight;
+        uint64_t seen = 0;
+        for (const auto& entry : weighted) {
+            seen += entry.second;
+            if (seen >= target) return entry.first;
+        }
+        return weighted.back().first;
     }
 };
 
-class PieChart : public Visualization {
+// -------------------- FULL-TEXT SEARCH (search.idx) --------------------
+// Inverted index over session notes and todo descriptions. Terms are lowercased
+// alphanumeric runs. Each term keeps (document gap, term count) pairs as varints,
+// and documents are numbered in the order they were indexed, so indexing one
+// only appends to the lists of its own terms. Removed todos are tombstoned.
+class TextIndex {
+public:
+    enum class Kind : uint8_t { Session, Todo };
+   
+    struct Hit {
+        Kind kind;
+        int id;
+        double score;
+    };
+   
 private:
-    string title;
-    vector<pair<string, int>> data;
+    static constexpr char MAGIC[4] = {'S', 'S', 'T', 'X'};
+    static constexpr size_t MAX_TERM = 32;
+   
+    struct Document {
+        Kind kind;
+        int id;
+        uint32_t length;   // terms in the text, for length normalization
+        bool live;
+    };
+   
+    struct Postings {
+        vector<uint8_t> bytes;
+        uint32_t lastDoc = 0;
+        uint32_t docCount = 0;
+    };
+   
+    vector<Document> documents;
+    unordered_map<uint64_t, uint32_t> docOf;   // (kind, id) -> document number
+    map<string, Postings, less<>> terms;       // ordered, so a prefix is one contiguous range
+    uint64_t liveLength = 0;
+    uint32_t liveCount[2] = {0, 0};
+   
+    static uint64_t key(Kind kind, int id) { return (static_cast<uint64_t>(kind) << 32) | static_cast<uint32_t>(id); }
+   
+    static void putVarint(vector<uint8_t>& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
    
-    // SDL-related members
-    SDL_Window* window;
-    SDL_Renderer* renderer;
-    TTF_Font* font;
-    bool sdlInitialized;
-
-public:
-    PieChart(User* user, const string& title)
-        : Visualization(user, 80), title(title), window(nullptr), renderer(nullptr), font(nullptr), sdlInitialized(false) {}
+    // Unchecked; only used on lists built here or validated by load()
+    static uint32_t getVarint(const uint8_t*& p) {
+        uint32_t v = 0;
+        for (int shift = 0; ; shift += 7) {
+            uint8_t byte = *p++;
+            v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+    }
    
-    ~PieChart() {
-        // Clean up SDL resources if initialized
-        if (sdlInitialized) {
-            if (font) TTF_CloseFont(font);
-            if (renderer) SDL_DestroyRenderer(renderer);
-            if (window) SDL_DestroyWindow(window);
-            TTF_Quit();
-            SDL_Quit();
+    static bool readVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 35 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
         }
+        return false;
     }
    
-    void addDataPoint(const string& label, int value) {
-        data.push_back(make_pair(label, value));
+    // A loaded list must decode to docCount increasing documents ending at lastDoc
+    bool validPostings(const Postings& postings) const {
+        const uint8_t* p = postings.bytes.data();
+        const uint8_t* end = p + postings.bytes.size();
+        uint64_t doc = 0;
+        for (uint32_t i = 0; i < postings.docCount; i++) {
+            uint32_t gap, tf;
+            if (!readVarint(p, end, gap) || !readVarint(p, end, tf) || (i > 0 && gap == 0)) return false;
+            doc += gap;
+            if (doc >= documents.size()) return false;
+        }
+        return p == end && (postings.docCount == 0 || doc == postings.lastDoc);
     }
    
-    // Text-based rendering for console output
-    void renderTextBased() {
-        stringstream ss;
-        int total = 0;
-        for (const auto& pair : data) total += pair.second;
+public:
+    // Calls visit(term) for every lowercased alphanumeric run; bytes >= 0x80 count as
+    // letters so UTF-8 words stay whole. Over-long terms are cut to MAX_TERM.
+    template <typename Visitor>
+    static void tokenize(string_view text, Visitor visit) {
+        char term[MAX_TERM];
+        size_t length = 0;
+        for (size_t i = 0; i <= text.size(); i++) {
+            unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : 0;
+            if (isalnum(c) || c >= 0x80) {
+                if (length < MAX_TERM) term[length++] = static_cast<char>(tolower(c));
+            } else if (length > 0) {
+                visit(string_view(term, length));
+                length = 0;
+            }
+        }
+    }
+   
+    void clear() {
+        documents.clear();
+        docOf.clear();
+        terms.clear();
+        liveLength = 0;
+        liveCount[0] = liveCount[1] = 0;
+    }
+   
+    size_t liveDocuments(Kind kind) const { return liveCount[static_cast<int>(kind)]; }
+    size_t deadDocuments() const { return documents.size() - liveCount[0] - liveCount[1]; }
+   
+    // Idempotent, so journal replay can re-add records the saved index already has
+    bool add(Kind kind, int id, string_view text) {
+        if (!docOf.emplace(key(kind, id), static_cast<uint32_t>(documents.size())).second) return false;
+        uint32_t doc = documents.size();
        
-        ss << "+" << string(width - 2, '-') << "+" << endl;
-        ss << "|" << setw((width - 2 - title.length()) / 2) << " " << title
-           << setw((width - 2 - title.length() + 1) / 2) << " " << "|" << endl;
-        ss << "+" << string(width - 2, '-') << "+" << endl;
+        unordered_map<string, uint32_t> counts;
+        uint32_t length = 0;
+        tokenize(text, [&](string_view term) {
+            length++;
+            counts[string(term)]++;
+        });
+        for (const auto& entry : counts) {
+            auto it = terms.find(entry.first);
+            if (it == terms.end()) it = terms.emplace(string(entry.first), Postings()).first;
+            Postings& postings = it->second;
+            putVarint(postings.bytes, doc - postings.lastDoc);
+            putVarint(postings.bytes, entry.second);
+            postings.lastDoc = doc;
+            postings.docCount++;
+        }
+        documents.push_back({kind, id, length, true});
+        liveLength += length;
+        liveCount[static_cast<int>(kind)]++;
+        return true;
+    }
+   
+    bool remove(Kind kind, int id) {
+        auto it = docOf.find(key(kind, id));
+        if (it == docOf.end() || !documents[it->second].live) return false;
+        Document& document = documents[it->second];
+        document.live = false;
+        liveLength -= document.length;
+        liveCount[static_cast<int>(kind)]--;
+        return true;
+    }
+   
+    // Documents containing every query word, best BM25 score first. Each word also
+    // matches longer terms it is a prefix of ("calc" finds "calculus").
+    vector<Hit> search(string_view query, size_t limit) const {
+        vector<string> words;
+        tokenize(query, [&words](string_view term) { words.emplace_back(term); });
+        vector<Hit> hits;
+        size_t live = liveCount[0] + liveCount[1];
+        if (words.empty() || live == 0 || words.size() > 0xffff) return hits;
        
-        for (const auto& pair : data) {
-            double percentage = (total > 0) ? (pair.second * 100.0 / total) : 0.0;
-           
-            ss << "| " << left << setw(15) << pair.first.substr(0, 15) << " | "
-               << getBarSymbol(pair.second, total, width - 40) << " "
-               << fixed << setprecision(1) << right << setw(5) << percentage << "% | "
-               << right << setw(8) << Utils::formatDuration(pair.second) << " |" << endl;
+        const double k1 = 1.2, b = 0.75;
+        double averageLength = max(1.0, static_cast<double>(liveLength) / live);
+        vector<double> score(documents.size());
+        vector<uint16_t> matched(documents.size());   // query words matched so far
+        for (uint16_t w = 0; w < words.size(); w++) {
+            for (auto it = terms.lower_bound(words[w]);
+                 it != terms.end() && it->first.compare(0, words[w].size(), words[w]) == 0; ++it) {
+                const Postings& postings = it->second;
+                double idf = log(1.0 + (live - min<double>(postings.docCount, live) + 0.5) / (postings.docCount + 0.5));
+                const uint8_t* p = postings.bytes.data();
+                uint32_t doc = 0;
+                for (uint32_t i = 0; i < postings.docCount; i++) {
+                    doc += getVarint(p);
+                    uint32_t tf = getVarint(p);
+                    if (!documents[doc].live || matched[doc] < w) continue;
+                    matched[doc] = w + 1;
+                    double norm = k1 * (1 - b + b * documents[doc].length / averageLength);
+                    score[doc] += idf * tf * (k1 + 1) / (tf + norm);
+                }
+            }
         }
        
-        ss << "+" << string(width - 2, '-') << "+" << endl;
-        content = ss.str();
-        cout << content << endl;
+        for (uint32_t doc = 0; doc < documents.size(); doc++)
+            if (matched[doc] == words.size())
+                hits.push_back({documents[doc].kind, documents[doc].id, score[doc]});
+        size_t shown = min(limit, hits.size());
+        partial_sort(hits.begin(), hits.begin() + shown, hits.end(),
+                     [](const Hit& x, const Hit& y) { return x.score > y.score; });
+        hits.resize(shown);
+        return hits;
     }
    
-    // Initialize SDL for graphical rendering
-    bool initSDL() {
-        // Initialize SDL
-        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-            cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
-            return false;
+    // Layout: "SSTX" | u32 crc32c of the rest | documents | terms with their postings
+    vector<char> encode() const {
+        ByteWriter body;
+        body.i32(static_cast<int32_t>(documents.size()));
+        for (const auto& document : documents)
+            body.u8(static_cast<uint8_t>(document.kind)).i32(document.id)
+                .i32(static_cast<int32_t>(document.length)).u8(document.live);
+        body.i32(static_cast<int32_t>(terms.size()));
+        for (const auto& entry : terms) {
+            body.str(entry.first).i32(static_cast<int32_t>(entry.second.lastDoc))
+                .i32(static_cast<int32_t>(entry.second.docCount))
+                .i32(static_cast<int32_t>(entry.second.bytes.size()))
+                .raw(reinterpret_cast<const char*>(entry.second.bytes.data()), entry.second.bytes.size());
         }
-       
-       
-        if (TTF_Init() < 0) {
-            cerr << "SDL_ttf could not initialize! TTF_Error: " << TTF_GetError() << endl;
-            SDL_Quit();
+        ByteWriter out;
+        out.raw(MAGIC, sizeof(MAGIC))
+           .i32(static_cast<int32_t>(Checksum::crc32c(body.bytes().data(), body.bytes().size())))
+           .raw(body.bytes().data(), body.bytes().size());
+        return out.bytes();
+    }
+   
+    bool load(const string& filename) {
+        clear();
+        string data;
+        if (!TextScan::readFile(filename, data)) return false;
+        ByteReader header(data.data(), data.size());
+        const char* magic = header.skip(sizeof(MAGIC));
+        uint32_t crc = static_cast<uint32_t>(header.i32());
+        if (!header.ok() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+        const char* body = data.data() + sizeof(MAGIC) + sizeof(crc);
+        size_t bodySize = data.size() - sizeof(MAGIC) - sizeof(crc);
+        if (Checksum::crc32c(body, bodySize) != crc) {
+            cerr << filename << " is damaged, rebuilding the search index." << endl;
             return false;
         }
        
-        // to Create window
-        window = SDL_CreateWindow(("Study Time - " + title).c_str(),
-                                 SDL_WINDOWPOS_UNDEFINED,
-                                 SDL_WINDOWPOS_UNDEFINED,
-                                 800, 600,
-                                 SDL_WINDOW_SHOWN);
-        if (!window) {
-            cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << endl;
-            TTF_Quit();
-            SDL_Quit();
+        ByteReader in(body, bodySize);
+        int32_t documentCount = in.i32();
+        for (int32_t i = 0; in.ok() && i < documentCount; i++) {
+            Document document;
+            document.kind = static_cast<Kind>(in.u8() & 1);
+            document.id = in.i32();
+            document.length = static_cast<uint32_t>(in.i32());
+            document.live = in.u8() != 0;
+            if (!docOf.emplace(key(document.kind, document.id), static_cast<uint32_t>(documents.size())).second) break;
+            documents.push_back(document);
+            if (document.live) {
+                liveLength += document.length;
+                liveCount[static_cast<int>(document.kind)]++;
+            }
+        }
+        int32_t termCount = in.i32();
+        for (int32_t i = 0; in.ok() && i < termCount; i++) {
+            string term = in.str();
+            Postings postings;
+            postings.lastDoc = static_cast<uint32_t>(in.i32());
+            postings.docCount = static_cast<uint32_t>(in.i32());
+            int32_t size = in.i32();
+            const char* bytes = in.skip(size);
+            if (!bytes) break;
+            postings.bytes.assign(bytes, bytes + size);
+            if (!validPostings(postings)) break;
+            terms.emplace(move(term), move(postings));
+        }
+        if (!in.ok() || documents.size() != static_cast<size_t>(documentCount) ||
+            terms.size() != static_cast<size_t>(termCount)) {
+            clear();
             return false;
         }
+        return true;
+    }
+};
+
+// ==================== USER CLASS ====================
+class User {
+public:
+    // Distribution of finished session lengths and of their break time, per subject
+    struct SubjectSketches {
+        QuantileSketch focus;
+        QuantileSketch breaks;
+    };
+   
+    struct SubjectTotals {
+        int duration = 0;
+        int sessionCount = 0;
+    };
+   
+private:
+    int id;
+    string username;
+    string passwordSalt;
+    string passwordHash;
+    string fullName;
+    // Shared by sessions and todos; mutable because decoding the mapped history interns subjects
+    mutable SubjectDictionary subjects;
+    TodoList todoList;
+    int nextSessionId;
+   
+    // Session history is decoded lazily: after login the snapshot stays mapped and
+    // counts/aggregates read its columns until something needs the editable table.
+    mutable SessionTable sessions;
+    mutable MappedFile sessionMap;
+    mutable SessionStore::Columns sessionColumns;
+    mutable bool sessionsLoaded;
+    // Built on the first query and kept up to date as sessions are added
+    mutable SessionIndex sessionIndex;
+    mutable bool sessionIndexed;
+    // Loaded with the snapshot; rebuilt from sessions and todos when it is missing or out of step
+    mutable TextIndex searchIndex;
+    mutable bool searchReady;
+   
+    // Running totals indexed by SubjectId so reports and charts never rescan the history
+    vector<SubjectTotals> subjectTotals;
+    int totalStudyTime;
+    StudyRollup rollup;
+    mutable vector<SubjectSketches> sketches;   // indexed by SubjectId
+    mutable bool sketchesStale = false;          // a finished session was re-ended
+   
+    void addToTotals(SubjectId subject, int duration, int sessionCount) {
+        if (subject >= subjectTotals.size()) subjectTotals.resize(subjects.size());
+        subjectTotals[subject].duration += duration;
+        subjectTotals[subject].sessionCount += sessionCount;
+    }
+   
+    // Adds (sign = 1) or takes back out (sign = -1) one row's contribution
+    void recordSession(size_t row, int sign) {
+        addToTotals(sessions.subject[row], sign * sessions.duration[row], sign);
+        totalStudyTime += sign * sessions.duration[row];
+        rollup.apply(sessions.start[row], sessions.end[row], sessions.duration[row], sign);
+    }
+   
+    // Numeric columns of whichever copy of the history is live
+    size_t rowCount() const { return sessionsLoaded ? sessions.size() : sessionColumns.rows(); }
+    const int64_t* startColumn() const { return sessionsLoaded ? sessions.start.data() : sessionColumns.start; }
+    const int64_t* endColumn() const { return sessionsLoaded ? sessions.end.data() : sessionColumns.end; }
+    const int32_t* idColumn() const { return sessionsLoaded ? sessions.id.data() : sessionColumns.id; }
+    const int32_t* durationColumn() const { return sessionsLoaded ? sessions.duration.data() : sessionColumns.duration; }
+   
+    // Only finished sessions are sketched; one still running has no length yet
+    void sketchSession(SubjectId subject, time_t start, time_t end, int duration, int breakTime) const {
+        if (end <= start) return;
+        if (subject >= sketches.size()) sketches.resize(subjects.size());
+        sketches[subject].focus.add(duration);
+        if (breakTime > 0) sketches[subject].breaks.add(breakTime);
+    }
+   
+    // Sketches can't drop a sample, so a changed session rebuilds them once before the next read
+    void refreshSketches() const {
+        if (!sketchesStale) return;
+        sketchesStale = false;
+        sketches.clear();
+        for (size_t i = 0; i < sessions.size(); i++)
+            sketchSession(sessions.subject[i], sessions.start[i], sessions.end[i], sessions.duration[i], sessions.breakTime[i]);
+    }
+   
+    void rebuildTotals() {
+        subjectTotals.clear();
+        sketches.clear();
+        sketchesStale = false;
+        rollup.clear();
+        size_t n = rowCount();
+        const int64_t* start = startColumn();
+        const int64_t* end = endColumn();
+        const int32_t* duration = durationColumn();
+        const int32_t* breakTime = sessionsLoaded ? sessions.breakTime.data() : sessionColumns.breakTime;
+        totalStudyTime = ColumnKernels::sum(duration, n);
+        rollup.addAll(start, end, duration, n);
        
+        // A v3 file's subject codes are translated to SubjectIds once per code
+        vector<SubjectId> remap;
+        if (!sessionsLoaded && sessionColumns.subjectCode) {
+            remap.resize(sessionColumns.header->subjectCount);
+            for (uint32_t code = 0; code < remap.size(); code++)
+                remap[code] = subjects.intern(sessionColumns.view(sessionColumns.subjectTable[code]));
+        }
+        for (size_t i = 0; i < n; i++) {
+            SubjectId subject = sessionsLoaded ? sessions.subject[i]
+                              : sessionColumns.subjectCode ? remap[sessionColumns.subjectCode[i]]
+                              : subjects.intern(sessionColumns.subjectName(i));
+            addToTotals(subject, duration[i], 1);
+            sketchSession(subject, start[i], end[i], duration[i], breakTime[i]);
+        }
+    }
+   
+    void ensureSessionsLoaded() const {
+        if (sessionsLoaded) return;
+        sessionColumns.decode(sessions, subjects);
+        sessionColumns = SessionStore::Columns();
+        sessionMap.close();
+        sessionsLoaded = true;
+    }
+   
+    void ensureSessionIndex() const {
+        ensureSessionsLoaded();
+        if (sessionIndexed) return;
+        sessionIndex.rebuild(sessions);
+        sessionIndexed = true;
+    }
+   
+    void appendSession(int sessionId, const string& subject, time_t startTime, time_t endTime, const string& notes) {
+        size_t row = sessions.append(sessionId, subjects.intern(subject), startTime, endTime, notes);
+        recordSession(row, 1);
+        if (sessionIndexed) sessionIndex.add(sessions, row);
+        if (searchReady) searchIndex.add(TextIndex::Kind::Session, sessionId, notes);
+    }
+   
+    void ensureSearchIndex() const {
+        size_t todos = todoList.size();
+        if (searchReady && searchIndex.liveDocuments(TextIndex::Kind::Session) == rowCount() &&
+            searchIndex.liveDocuments(TextIndex::Kind::Todo) == todos &&
+            searchIndex.deadDocuments() <= rowCount() + todos) return;
+        ensureSessionsLoaded();
+        searchIndex.clear();
+        for (size_t row = 0; row < sessions.size(); row++)
+            searchIndex.add(TextIndex::Kind::Session, sessions.id[row], sessions.notes[row]);
+        for (const auto& item : todoList.getAllItems())
+            searchIndex.add(TextIndex::Kind::Todo, item.getId(), item.getDescription());
+        searchReady = true;
+    }
+
+public:
+    struct Credentials {
+        string salt;
+        string hash;
+
+        static Credentials fromPassword(const string& password) {
+            Credentials credentials;
+            credentials.salt = Password::makeSalt();
+            credentials.hash = Password::hash(credentials.salt, password);
+            return credentials;
+        }
+    };
+
+    User(int id, const string& username, const string& password, const string& fullName = "")
+        : User(id, username, Credentials::fromPassword(password), fullName) {}
+   
+    // Account restored from the user registry with an already hashed password
+    User(int id, const string& username, const Credentials& credentials, const string& fullName)
+        : id(id), username(username), passwordSalt(credentials.salt), passwordHash(credentials.hash),
+          fullName(fullName), todoList(subjects), nextSessionId(1), sessionsLoaded(true), sessionIndexed(false),
+          searchReady(false), totalStudyTime(0) {}
+   
+    int getId() const { return id; }
+    const string& getUsername() const { return username; }
+    const string& getFullName() const { return fullName; }
+    bool verifyPassword(const string& pwd) const {
+        return Password::equals(passwordHash, Password::hash(passwordSalt, pwd));
+    }
+    Credentials getCredentials() const { return {passwordSalt, passwordHash}; }
+   
+    int startSession(const string& subject, time_t startTime, const string& notes = "") {
+        ensureSessionsLoaded();
+        appendSession(nextSessionId, subject, startTime, startTime, notes);   // end <= start: still running
+        return nextSessionId++;
+    }
+   
+    bool endSession(int sessionId, time_t endTime, int breakTime = 0) {
+        ensureSessionsLoaded();
+        long row = sessions.find(sessionId);
+        if (row < 0) return false;
+        bool wasFinished = sessions.end[row] > sessions.start[row];
+        bool changed = sessions.end[row] != endTime || sessions.breakTime[row] != breakTime;
+        recordSession(row, -1);
+        sessions.setEnd(row, endTime, breakTime);
+        recordSession(row, 1);
+        // Only the first end adds a sample; replaying an end already in the snapshot is a no-op
+        if (!wasFinished) sketchSession(sessions.subject[row], sessions.start[row], endTime, sessions.duration[row], breakTime);
+        else if (changed) sketchesStale = true;
+        return true;
+    }
+   
+    // One session read in place; edits go through the User methods below
+    optional<SessionView> getSession(int sessionId) const {
+        ensureSessionsLoaded();
+        long row = sessions.find(sessionId);
+        if (row < 0) return nullopt;
+        return SessionView(sessions, subjects, row);
+    }
+   
+    // Sub-second start, pause, resume and end stamps from the live timer
+    bool setTimeline(int sessionId, const vector<int64_t>& timeline) {
+        ensureSessionsLoaded();
+        long row = sessions.find(sessionId);
+        if (row < 0) return false;
+        sessions.timeline[row] = timeline;
+        return true;
+    }
+   
+    bool attachImage(int sessionId, const string& path) {
+        ensureSessionsLoaded();
+        long row = sessions.find(sessionId);
+        if (row < 0) return false;
+        sessions.image[row] = path;
+        return true;
+    }
+   
+    bool attachFile(int sessionId, const string& path) {
+        ensureSessionsLoaded();
+        long row = sessions.find(sessionId);
+        if (row < 0) return false;
+        sessions.files[row].push_back(path);
+        return true;
+    }
+   
+    // Apply one journal record on top of the loaded snapshot. Every operation is
+    // idempotent so a journal that outlived its compaction replays safely.
+    bool applyJournalRecord(JournalOp op, ByteReader& in) {
+        switch (op) {
+            case JournalOp::SessionStarted: {
+                int sessionId = in.i32();
+                string subject = in.str();
+                time_t startTime = in.i64();
+                string notes = in.str();
+                if (!in.ok()) return false;
+                ensureSessionsLoaded();
+                if (sessions.find(sessionId) < 0)
+                    appendSession(sessionId, subject, startTime, startTime, notes);
+                if (sessionId >= nextSessionId) nextSessionId = sessionId + 1;
+                return true;
+            }
+            case JournalOp::SessionEnded: {
+                int sessionId = in.i32();
+                time_t endTime = in.i64();
+                int breakTime = in.i32();
+                return in.ok() && endSession(sessionId, endTime, breakTime);
+            }
+            case JournalOp::SessionTimed: {
+                int sessionId = in.i32();
+                int32_t count = in.i32();
+                if (!in.ok() || count < 0 || count > SessionTable::MAX_TIMELINE) return false;
+                vector<int64_t> timeline(count);
+                for (int64_t& mark : timeline) mark = in.i64();
+                return in.ok() && setTimeline(sessionId, timeline);
+            }
+            case JournalOp::ImageAttached:
+            case JournalOp::FileAttached: {
+                int sessionId = in.i32();
+                string path = in.str();
+                if (!in.ok()) return false;
+                ensureSessionsLoaded();
+                long row = sessions.find(sessionId);
+                if (row < 0) return false;
+                vector<string>& files = sessions.files[row];
+                if (op == JournalOp::ImageAttached) sessions.image[row] = path;
+                else if (find(files.begin(), files.end(), path) == files.end()) files.push_back(path);
+                return true;
+            }
+            case JournalOp::TodoAdded: {
+                int itemId = in.i32();
+                string description = in.str();
+                int priority = in.i32();
+                time_t dueDate = in.i64();
+                string subject = in.str();
+                if (!in.ok()) return false;
+                todoList.restoreItem(TodoItem(subjects, itemId, description, priority, dueDate, subject));
+                if (searchReady) searchIndex.add(TextIndex::Kind::Todo, itemId, description);
+                return true;
+            }
+            case JournalOp::TodoCompleted: {
+                int itemId = in.i32();
+                bool status = in.u8() != 0;
+                return in.ok() && todoList.markAsCompleted(itemId, status);
+            }
+            case JournalOp::TodoRemoved: {
+                int itemId = in.i32();
+                if (!in.ok()) return false;
+                todoList.removeItem(itemId);
+                searchIndex.remove(TextIndex::Kind::Todo, itemId);
+                return true;
+            }
+        }
+        return false;
+    }
+   
+    // Sessions matching `query`, read in place. Subject and time range are answered by
+    // the start-time indexes; when nothing else filters, a page costs O(log n + limit).
+    vector<SessionView> querySessions(const SessionQuery& query) const {
+        ensureSessionIndex();
+        vector<SessionView> result;
+        optional<SubjectId> subjectId;
+        if (query.subject) {
+            SubjectId found;
+            if (!subjects.find(*query.subject, found)) return result;
+            subjectId = found;
+        }
+        SessionIndex::Range rows = sessionIndex.range(sessions, subjectId, query.from, query.to);
+        auto matches = [&](uint32_t row) {
+            if (query.minDuration && sessions.duration[row] < *query.minDuration) return false;
+            return !query.withAttachments || !sessions.image[row].empty() || !sessions.files[row].empty();
+        };
+       
+        if (query.order == SessionQuery::Order::LongestFirst) {
+            vector<uint32_t> hits;
+            for (const uint32_t* row = rows.first; row != rows.last; ++row)
+                if (matches(*row)) hits.push_back(*row);
+            if (query.offset >= hits.size()) return result;
+            size_t end = hits.size() - query.offset > query.limit ? query.offset + query.limit : hits.size();
+            partial_sort(hits.begin(), hits.begin() + end, hits.end(), [this](uint32_t a, uint32_t b) {
+                return sessions.duration[a] != sessions.duration[b] ? sessions.duration[a] > sessions.duration[b]
+                                                                    : sessions.start[a] > sessions.start[b];
+            });
+            for (size_t i = query.offset; i < end; i++) result.emplace_back(sessions, subjects, hits[i]);
+            return result;
+        }
+       
+        bool newestFirst = query.order == SessionQuery::Order::NewestFirst;
+        if (!query.minDuration && !query.withAttachments) {
+            // Every indexed row matches, so the page is found by position alone
+            if (query.offset >= rows.size()) return result;
+            size_t count = min(query.limit, rows.size() - query.offset);
+            result.reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                size_t at = query.offset + i;
+                result.emplace_back(sessions, subjects, newestFirst ? rows.last[-1 - static_cast<ptrdiff_t>(at)] : rows.first[at]);
+            }
+            return result;
+        }
+       
+        size_t skipped = 0;
+        for (size_t i = 0; i < rows.size() && result.size() < query.limit; i++) {
+            uint32_t row = newestFirst ? rows.last[-1 - static_cast<ptrdiff_t>(i)] : rows.first[i];
+            if (!matches(row)) continue;
+            if (skipped < query.offset) skipped++;
+            else result.emplace_back(sessions, subjects, row);
+        }
+        return result;
+    }
+   
+    size_t getSessionCount() const { return rowCount(); }
+   
+    int getLatestSessionId() const {
+        int32_t lowest, highest;
+        return ColumnKernels::minMax(idColumn(), rowCount(), lowest, highest) ? highest : 0;
+    }
+   
+    // Shortest and longest session; false when there are none
+    bool getDurationRange(int& shortest, int& longest) const {
+        int32_t lo, hi;
+        if (!ColumnKernels::minMax(durationColumn(), rowCount(), lo, hi)) return false;
+        shortest = lo;
+        longest = hi;
+        return true;
+    }
+   
+    // Session counts per `bucketSeconds`-wide duration bucket; the last bucket is open-ended
+    vector<uint32_t> getDurationHistogram(int bucketSeconds, size_t buckets) const {
+        vector<uint32_t> counts(buckets);
+        ColumnKernels::histogram(durationColumn(), rowCount(), bucketSeconds, counts.data(), buckets);
+        return counts;
+    }
+   
+    // Study time per SubjectId over sessions starting in [from, to), in one pass over
+    // whichever copy of the history is live; a mapped file is not decoded
+    vector<int64_t> getStudyTimeBySubject(time_t from, time_t to) const {
+        vector<int64_t> totals(subjects.size());
+        size_t n = rowCount();
+        const int64_t* start = startColumn();
+        const int32_t* duration = durationColumn();
+        if (sessionsLoaded) {
+            ColumnKernels::groupedSum(duration, sessions.subject.data(), start, n, from, to, totals.data());
+        } else if (sessionColumns.subjectCode) {
+            // Sum by file code, then translate each code once (rebuildTotals interned them all)
+            vector<int64_t> byCode(sessionColumns.header->subjectCount);
+            ColumnKernels::groupedSum(duration, sessionColumns.subjectCode, start, n, from, to, byCode.data());
+            for (uint32_t code = 0; code < byCode.size(); code++) {
+                SubjectId subject;
+                if (byCode[code] && subjects.find(sessionColumns.view(sessionColumns.subjectTable[code]), subject))
+                    totals[subject] += byCode[code];
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                SubjectId subject;
+                if (start[i] >= from && start[i] < to && subjects.find(sessionColumns.subjectName(i), subject))
+                    totals[subject] += duration[i];
+            }
+        }
+        return totals;
+    }
+   
+    // Indexed by SubjectId; subjects without sessions have a zero sessionCount
+    const vector<SubjectTotals>& getSubjectTotals() const { return subjectTotals; }
+    const SubjectDictionary& getSubjects() const { return subjects; }
+    const StudyRollup& getRollup() const { return rollup; }
+   
+    // Sketches of one subject, or empty ones when it has no finished sessions
+    const SubjectSketches& getSketches(const string& subject) const {
+        static const SubjectSketches none;
+        SubjectId subjectId;
+        refreshSketches();
+        if (!subjects.find(subject, subjectId) || subjectId >= sketches.size()) return none;
+        return sketches[subjectId];
+    }
+   
+    // All subjects merged into one pair of sketches
+    SubjectSketches getOverallSketches() const {
+        refreshSketches();
+        SubjectSketches overall;
+        for (const auto& subject : sketches) {
+            overall.focus.merge(subject.focus);
+            overall.breaks.merge(subject.breaks);
+        }
+        return overall;
+    }
+   
+    // Visits every subject that has sessions, in the order subjects were first seen
+    template <typename Visitor>
+    void forEachSubjectTotal(Visitor visit) const {
+        for (SubjectId subject = 0; subject < subjectTotals.size(); subject++)
+            if (subjectTotals[subject].sessionCount > 0) visit(subjects.name(subject), subjectTotals[subject]);
+    }
+   
+    int getTotalStudyTime() const { return totalStudyTime; }
+   
+    // Todos added or removed here are kept in the search index as well
+    int addTodoItem(const string& description, int priority = 2, time_t dueDate = 0, const string& subject = "") {
+        int itemId = todoList.addItem(description, priority, dueDate, subject);
+        if (searchReady) searchIndex.add(TextIndex::Kind::Todo, itemId, description);
+        return itemId;
+    }
+   
+    bool removeTodoItem(int itemId) {
+        if (!todoList.removeItem(itemId)) return false;
+        searchIndex.remove(TextIndex::Kind::Todo, itemId);
+        return true;
+    }
+   
+    // Session notes and todo descriptions containing every word of `query`, best first
+    vector<TextIndex::Hit> search(const string& query, size_t limit = 20) const {
+        ensureSearchIndex();
+        return searchIndex.search(query, limit);
+    }
+   
+    TodoList& getTodoList() { return todoList; }
+    const TodoList& getTodoList() const { return todoList; }
+   
+    // Everything saveUserData writes, captured in memory so it can be written off-thread
+    struct Snapshot {
+        // Null while the history is still mapped, i.e. unchanged on disk. The columns are
+        // copied rather than encoded so the menu thread only pays for the copy.
+        shared_ptr<const SessionTable> sessions;
+        shared_ptr<const SubjectDictionary> subjects;
+        int nextSessionId = 1;
+        string todoText;
+        vector<char> searchImage;   // empty when the index was never built this login
+       
+        bool write(const string& sessionFile, const string& todoFile, const string& indexFile = "") const {
+            if (sessions && !SessionStore::writeImage(sessionFile, SessionStore::encode(*sessions, *subjects, nextSessionId)))
+                return false;
+            string sealed = Checkpoint::sealText(todoText);
+            if (!Checkpoint::writeFile(todoFile, sealed.data(), sealed.size())) return false;
+            if (indexFile.empty()) return true;
+            // An index older than this snapshot would be wrong, so drop it rather than keep it
+            if (searchImage.empty()) return unlink(indexFile.c_str()) == 0 || errno == ENOENT;
+            return Checkpoint::writeFile(indexFile, searchImage.data(), searchImage.size());
+        }
+    };
+   
+    Snapshot snapshot() const {
+        Snapshot snap;
+        if (sessionsLoaded) {
+            snap.sessions = make_shared<const SessionTable>(sessions.columnsCopy());
+            // Interning in id order gives the copy the same SubjectIds
+            auto names = make_shared<SubjectDictionary>();
+            for (SubjectId id = 1; id < subjects.size(); id++) names->intern(subjects.name(id));
+            snap.subjects = move(names);
+            snap.nextSessionId = nextSessionId;
+        }
+        snap.todoText = todoList.serializeAll();
+        if (searchReady) snap.searchImage = searchIndex.encode();
+        return snap;
+    }
+   
+    bool saveUserData(const string& sessionFile, const string& todoFile, const string& indexFile = "") const {
+        return snapshot().write(sessionFile, todoFile, indexFile);
+    }
+   
+    // Without an indexFile the search index is left to be built on first use
+    bool loadUserData(const string& sessionFile, const string& todoFile, const string& indexFile = "") {
+        sessions.clear();
+        sessionsLoaded = true;
+        sessionIndexed = false;
+        searchReady = !indexFile.empty() && searchIndex.load(indexFile);
+        // Latest checkpoint first, then the one it replaced if the latest is damaged
+        for (const string& candidate : {sessionFile, Checkpoint::previous(sessionFile)}) {
+            if (SessionStore::mapFile(candidate, sessionMap, sessionColumns)) {
+                sessionsLoaded = false;
+                nextSessionId = sessionColumns.header->nextSessionId;
+                rebuildTotals();
+                return todoList.loadFromFile(todoFile);
+            }
+            if (SessionStore::read(candidate, sessions, subjects, nextSessionId)) {
+                rebuildTotals();
+                return todoList.loadFromFile(todoFile);
+            }
+            if (candidate == sessionFile && SessionStore::isBinaryFile(sessionFile))
+                cerr << sessionFile << " is damaged, trying the previous checkpoint." << endl;
+        }
+
+        // Old pipe-delimited format; it is rewritten as binary on the next save
+        string text;
+        if (!SessionStore::isBinaryFile(sessionFile) && TextScan::readFile(sessionFile, text)) {
+            sessions.clear();
+            nextSessionId = 1;
+           
+            TextScan::LineScanner scanner(text.data(), text.size());
+            TextScan::Record record;
+            while (scanner.next(record)) {
+                if (record.line.substr(0, 8) == "NEXT_ID=")
+                    nextSessionId = TextScan::toNumber<int>(record.line.substr(8), 1);
+                else sessions.append(StudySession::fromRecord(record, subjects));
+            }
+        }
+        rebuildTotals();
+        return todoList.loadFromFile(todoFile);
+    }
+   
+};
+
+// -------------------- OPERATION JOURNAL (journal.log) --------------------
+// Each mutation is appended as [u32 length][u32 crc32c][u8 op][payload] so saving
+// costs O(1). The file starts with a "SSJ2" tag; journals from before checksums
+// have no tag and no crc field. On login the journal is replayed over the last
+// snapshot; FileManager folds it back into the snapshot once it grows past
+// JOURNAL_COMPACT_BYTES.
+class Journal {
+private:
+    static constexpr char MAGIC[4] = {'S', 'S', 'J', '2'};
+
+    static vector<char> frame(JournalOp op, const ByteWriter& payload) {
+        vector<char> body(1, static_cast<char>(op));
+        body.insert(body.end(), payload.bytes().begin(), payload.bytes().end());
+        ByteWriter record;
+        record.i32(static_cast<int32_t>(body.size()))
+              .i32(static_cast<int32_t>(Checksum::crc32c(body.data(), body.size())));
+        vector<char> out = record.bytes();
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    }
+
+public:
+    static vector<char> sessionStarted(const SessionView& session) {
+        return frame(JournalOp::SessionStarted, ByteWriter().i32(session.getId()).str(session.getSubject())
+                                                    .i64(session.getStartTime()).str(session.getNotes()));
+    }
+    static vector<char> sessionEnded(int sessionId, time_t endTime, int breakTime) {
+        return frame(JournalOp::SessionEnded, ByteWriter().i32(sessionId).i64(endTime).i32(breakTime));
+    }
+    static vector<char> sessionTimed(int sessionId, const vector<int64_t>& timeline) {
+        ByteWriter payload;
+        payload.i32(sessionId).i32(static_cast<int32_t>(timeline.size()));
+        for (int64_t mark : timeline) payload.i64(mark);
+        return frame(JournalOp::SessionTimed, payload);
+    }
+    static vector<char> imageAttached(int sessionId, const string& path) {
+        return frame(JournalOp::ImageAttached, ByteWriter().i32(sessionId).str(path));
+    }
+    static vector<char> fileAttached(int sessionId, const string& path) {
+        return frame(JournalOp::FileAttached, ByteWriter().i32(sessionId).str(path));
+    }
+    static vector<char> todoAdded(const TodoItem& item) {
+        return frame(JournalOp::TodoAdded, ByteWriter().i32(item.getId()).str(item.getDescription())
+                                               .i32(item.getPriority()).i64(item.getDueDate())
+                                               .str(item.getSubject()));
+    }
+    static vector<char> todoCompleted(int itemId, bool status) {
+        return frame(JournalOp::TodoCompleted, ByteWriter().i32(itemId).u8(status ? 1 : 0));
+    }
+    static vector<char> todoRemoved(int itemId) {
+        return frame(JournalOp::TodoRemoved, ByteWriter().i32(itemId));
+    }
+
+    // Appends and fsyncs; returns the journal size afterwards, or -1 on failure
+    static long append(const string& filename, const vector<char>& records) {
+        int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) return -1;
+        struct stat info;
+        vector<char> bytes;
+        if (fstat(fd, &info) == 0 && info.st_size == 0) bytes.assign(MAGIC, MAGIC + sizeof(MAGIC));
+        bytes.insert(bytes.end(), records.begin(), records.end());
+        bool written = write(fd, bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()) &&
+                       fsync(fd) == 0 && fstat(fd, &info) == 0;
+        ::close(fd);
+        return written ? static_cast<long>(info.st_size) : -1;
+    }
+
+    static bool truncate(const string& filename) {
+        ofstream file(filename, ios::binary | ios::trunc);
+        return file.is_open();
+    }
+
+    // True when the journal holds anything beyond its format tag
+    static bool hasRecords(const string& filename) {
+        error_code ec;
+        uintmax_t size = fs::file_size(filename, ec);
+        return !ec && size > sizeof(MAGIC);
+    }
+
+    static bool isTagged(const string& data) {
+        return data.size() >= sizeof(MAGIC) && memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    // Applies records up to the end or the first damaged one, leaving goodBytes just past
+    // the last intact record. Records of an untagged journal are reframed into `upgraded`.
+    static int applyRecords(const string& data, User& user, size_t& goodBytes, vector<char>* upgraded) {
+        bool tagged = isTagged(data);
+        goodBytes = tagged ? sizeof(MAGIC) : 0;
+        int applied = 0;
+        ByteReader in(data.data() + goodBytes, data.size() - goodBytes);
+        while (true) {
+            int32_t length = in.i32();
+            uint32_t crc = tagged ? static_cast<uint32_t>(in.i32()) : 0;
+            const char* body = in.skip(length);
+            if (!in.ok() || length < 1 || !body) break;
+            if (tagged && Checksum::crc32c(body, length) != crc) break;
+
+            ByteReader record(body, length);
+            JournalOp op = static_cast<JournalOp>(record.u8());
+            if (user.applyJournalRecord(op, record)) applied++;
+            goodBytes = body + length - data.data();
+            if (upgraded) {
+                vector<char> reframed = frame(op, ByteWriter().raw(body + 1, length - 1));
+                upgraded->insert(upgraded->end(), reframed.begin(), reframed.end());
+            }
+        }
+        return applied;
+    }
+
+    // The owner's replay at login. A torn or corrupted record (crash mid-append, bad
+    // sector) ends the replay and is cut off, so later appends are not hidden behind it.
+    // An untagged journal from before checksums is rewritten in the current format.
+    static int replay(const string& filename, User& user) {
+        string data;
+        if (!TextScan::readFile(filename, data) || data.empty()) return 0;
+
+        bool tagged = isTagged(data);
+        size_t goodBytes;
+        vector<char> upgraded;
+        int applied = applyRecords(data, user, goodBytes, tagged ? nullptr : &upgraded);
+
+        if (!tagged) {
+            vector<char> rewritten(MAGIC, MAGIC + sizeof(MAGIC));
+            rewritten.insert(rewritten.end(), upgraded.begin(), upgraded.end());
+            Checkpoint::writeFile(filename, rewritten.data(), rewritten.size());
+            unlink(Checkpoint::previous(filename).c_str());
+        } else if (goodBytes < data.size()) {
+            cerr << filename << ": dropped " << (data.size() - goodBytes) << " damaged bytes at the end." << endl;
+            error_code ec;
+            fs::resize_file(filename, goodBytes, ec);
+        }
+        return applied;
+    }
+
+    // For readers other than the owner, such as the ranking scan, which may run while the
+    // journal is being appended to: applies the intact prefix and never writes or logs.
+    // A half-appended record just ends the replay.
+    static int replayReadOnly(const string& filename, User& user) {
+        string data;
+        if (!TextScan::readFile(filename, data) || data.empty()) return 0;
+        size_t goodBytes;
+        return applyRecords(data, user, goodBytes, nullptr);
+    }
+};
+
+User* currentUser = nullptr;
+class FileUploader {
+private:
+    string uploadDir;
+   
+public:
+    FileUploader(const string& dir = "uploads") : uploadDir(dir) {
+        // to create upload directory when the file does not exist
+        fs::create_directories(uploadDir);
+    }
+   
+    bool uploadFile(const string& sourcePath, const string& destFilename, string& outPath) {
+        if (!fs::exists(sourcePath)) {
+            cerr << "Source file does not exist: " << sourcePath << endl;
+            return false;
+        }
+       
+        // Create user specific directory
+        string userDir = uploadDir + "/" + to_string(currentUser->getId());
+        fs::create_directories(userDir);
+       
+        // Generate destination path
+        string destPath = userDir + "/" + destFilename;
+       
+        try {
+            // Copy of the file
+            fs::copy_file(sourcePath, destPath, fs::copy_options::overwrite_existing);
+            outPath = destPath;
+            return true;
+        } catch (const fs::filesystem_error& e) {
+            cerr << "Error copying file: " << e.what() << endl;
+            return false;
+        }
+    }
+   
+};
+//----------------SDL FUNCTIONS--------------------
+// Text for the SDL screens. Printable ASCII is rasterized once per font into a
+// white glyph atlas, and each distinct string is laid out once into quads over it;
+// drawing is one tinted SDL_RenderGeometry call. Strings outside ASCII fall back to
+// one cached texture each. Frames that repeat their text allocate no surfaces or
+// textures and rasterize nothing.
+class TextCache {
+private:
+    static constexpr int FIRST_GLYPH = 32, LAST_GLYPH = 126;
+    static constexpr int ATLAS_WIDTH = 512;
+    static constexpr uint32_t SWEEP_FRAMES = 60;   // about a second at the chart's frame rate
+   
+    struct Glyph {
+        SDL_Rect src = {0, 0, 0, 0};   // position in the atlas
+        int offsetX = 0;               // image left edge relative to the pen
+        int advance = 0;
+    };
+   
+    struct Layout {
+        vector<SDL_Vertex> vertices;      // white quads at the origin, four per glyph
+        SDL_Texture* texture = nullptr;   // whole-string fallback
+        int width = 0, height = 0;
+        uint32_t lastFrame = 0;           // frame of the latest draw
+    };
+   
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    SDL_Texture* atlas = nullptr;
+    int atlasHeight = 0;
+    array<Glyph, LAST_GLYPH - FIRST_GLYPH + 1> glyphs;
+    unordered_map<string, Layout> layouts;
+    uint32_t frame = 0;
+    vector<SDL_Vertex> scratch;
+    vector<int> quadIndices;
+   
+    void buildAtlas() {
+        const SDL_Color white = {255, 255, 255, 255};
+        vector<SDL_Surface*> images(glyphs.size(), nullptr);
+        int penX = 0, penY = 0, rowHeight = 0;
+        for (int c = FIRST_GLYPH; c <= LAST_GLYPH; c++) {
+            Glyph& glyph = glyphs[c - FIRST_GLYPH];
+            int minX, maxX, minY, maxY, advance;
+            if (TTF_GlyphMetrics(font, c, &minX, &maxX, &minY, &maxY, &advance) != 0) continue;
+            glyph.advance = advance;
+            glyph.offsetX = min(minX, 0);
+           
+            SDL_Surface* rendered = TTF_RenderGlyph_Blended(font, c, white);
+            if (!rendered) continue;
+            SDL_Surface* image = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+            SDL_FreeSurface(rendered);
+            if (!image) continue;
+           
+            // Shelf packing with a one pixel gutter so sampling never bleeds
+            if (penX + image->w > ATLAS_WIDTH) {
+                penX = 0;
+                penY += rowHeight + 1;
+                rowHeight = 0;
+            }
+            glyph.src = {penX, penY, image->w, image->h};
+            penX += image->w + 1;
+            rowHeight = max(rowHeight, image->h);
+            images[c - FIRST_GLYPH] = image;
+        }
+        atlasHeight = penY + rowHeight;
+       
+        vector<uint32_t> pixels(static_cast<size_t>(ATLAS_WIDTH) * atlasHeight, 0);
+        for (size_t g = 0; g < images.size(); g++) {
+            SDL_Surface* image = images[g];
+            if (!image) continue;
+            const SDL_Rect& src = glyphs[g].src;
+            SDL_LockSurface(image);
+            for (int row = 0; row < src.h; row++)
+                memcpy(&pixels[static_cast<size_t>(src.y + row) * ATLAS_WIDTH + src.x],
+                       static_cast<const char*>(image->pixels) + row * image->pitch, src.w * sizeof(uint32_t));
+            SDL_UnlockSurface(image);
+            SDL_FreeSurface(image);
+        }
+        if (atlasHeight == 0) return;
+       
+        atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, ATLAS_WIDTH, atlasHeight);
+        if (!atlas) {
+            cerr << "Could not create the glyph atlas: " << SDL_GetError() << endl;
+            return;
+        }
+        SDL_UpdateTexture(atlas, nullptr, pixels.data(), ATLAS_WIDTH * sizeof(uint32_t));
+        SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    }
+   
+    Layout layoutText(const string& text) const {
+        Layout layout;
+        bool ascii = atlas && all_of(text.begin(), text.end(),
+                                     [](char c) { return c >= FIRST_GLYPH && c <= LAST_GLYPH; });
+        if (!ascii) {
+            const SDL_Color white = {255, 255, 255, 255};
+            SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), white);
+            if (!surface) return layout;
+            layout.texture = SDL_CreateTextureFromSurface(renderer, surface);
+            layout.width = surface->w;
+            layout.height = surface->h;
+            SDL_FreeSurface(surface);
+            return layout;
+        }
+       
+        layout.vertices.reserve(text.size() * 4);
+        int pen = 0;
+        Uint16 previous = 0;
+        for (char c : text) {
+            Uint16 code = static_cast<Uint16>(c);
+            const Glyph& glyph = glyphs[code - FIRST_GLYPH];
+            if (previous) pen += TTF_GetFontKerningSizeGlyphs(font, previous, code);
+            previous = code;
+            if (glyph.src.w > 0) {
+                float x0 = static_cast<float>(pen + glyph.offsetX), x1 = x0 + glyph.src.w;
+                float y1 = static_cast<float>(glyph.src.h);
+                float u0 = static_cast<float>(glyph.src.x) / ATLAS_WIDTH;
+                float u1 = static_cast<float>(glyph.src.x + glyph.src.w) / ATLAS_WIDTH;
+                float v0 = static_cast<float>(glyph.src.y) / atlasHeight;
+                float v1 = static_cast<float>(glyph.src.y + glyph.src.h) / atlasHeight;
+                SDL_Color white = {255, 255, 255, 255};
+                layout.vertices.push_back({{x0, 0.0f}, white, {u0, v0}});
+                layout.vertices.push_back({{x1, 0.0f}, white, {u1, v0}});
+                layout.vertices.push_back({{x0, y1}, white, {u0, v1}});
+                layout.vertices.push_back({{x1, y1}, white, {u1, v1}});
+            }
+            pen += glyph.advance;
+        }
+        layout.width = pen;
+        layout.height = TTF_FontHeight(font);
+        return layout;
+    }
+
+public:
+    TextCache(SDL_Renderer* renderer, TTF_Font* font) : renderer(renderer), font(font) {
+        if (font) buildAtlas();
+    }
+    TextCache(const TextCache&) = delete;
+    TextCache& operator=(const TextCache&) = delete;
+   
+    ~TextCache() {
+        clear();
+        if (atlas) SDL_DestroyTexture(atlas);
+    }
+   
+    void clear() {
+        for (auto& entry : layouts)
+            if (entry.second.texture) SDL_DestroyTexture(entry.second.texture);
+        layouts.clear();
+    }
+   
+    size_t size() const { return layouts.size(); }
+   
+    // Call once per presented frame; strings not drawn for SWEEP_FRAMES frames are released
+    void endFrame() {
+        if (++frame % SWEEP_FRAMES != 0) return;
+        for (auto it = layouts.begin(); it != layouts.end(); ) {
+            if (frame - it->second.lastFrame <= SWEEP_FRAMES) {
+                ++it;
+                continue;
+            }
+            if (it->second.texture) SDL_DestroyTexture(it->second.texture);
+            it = layouts.erase(it);
+        }
+    }
+   
+    void draw(const string& text, int x, int y, SDL_Color color, bool centered) {
+        if (!font || text.empty()) return;
+        auto it = layouts.find(text);
+        if (it == layouts.end()) {
+            it = layouts.emplace(text, layoutText(text)).first;
+        }
+        Layout& layout = it->second;
+        layout.lastFrame = frame;
+        if (centered) {
+            x -= layout.width / 2;
+            y -= layout.height / 2;
+        }
+       
+        if (layout.texture) {
+            SDL_SetTextureColorMod(layout.texture, color.r, color.g, color.b);
+            SDL_Rect rect = {x, y, layout.width, layout.height};
+            SDL_RenderCopy(renderer, layout.texture, NULL, &rect);
+            return;
+        }
+       
+        size_t quads = layout.vertices.size() / 4;
+        if (quads == 0) return;
+        scratch.assign(layout.vertices.begin(), layout.vertices.end());
+        for (SDL_Vertex& v : scratch) {
+            v.position.x += x;
+            v.position.y += y;
+            v.color = color;
+        }
+        while (quadIndices.size() < quads * 6) {
+            int base = static_cast<int>(quadIndices.size() / 6 * 4);
+            quadIndices.insert(quadIndices.end(), {base, base + 1, base + 2, base + 2, base + 1, base + 3});
+        }
+        SDL_RenderGeometry(renderer, atlas, scratch.data(), static_cast<int>(scratch.size()),
+                           quadIndices.data(), static_cast<int>(quads * 6));
+    }
+};
+
+void renderText(TextCache& cache, const string& text, int x, int y, SDL_Color color, bool centered = false) {
+    cache.draw(text, x, y, color, centered);
+}
+
+// ==================== SDL PIE CHART CLASS ====================
+class SDLPieChart {
+private:
+    SDL_Renderer* renderer;
+    TextCache& text;
+    int centerX, centerY;
+    int radius;
+    string title;
+    vector<pair<string, int>> data;
+    vector<SDL_Color> colors;
+   
+    // Slices are one triangle fan each plus a one pixel rim that fades to transparent,
+    // which anti-aliases the edge. Built when the data changes, drawn with a single
+    // SDL_RenderGeometry call per frame.
+    static constexpr int CIRCLE_STEPS = 720;   // half a degree per rim segment
+    static constexpr float FEATHER = 1.0f;      // width of the faded rim in pixels
+   
+    struct SliceLabel {
+        int x, y;
+        string valueText;
+        string legendText;
+    };
+   
+    vector<SDL_Vertex> vertices;
+    vector<int> indices;
+    vector<SliceLabel> labels;
+    bool geometryDirty = true;
+   
+    // Unit vectors for every step, starting at the top and running clockwise
+    static const vector<SDL_FPoint>& unitCircle() {
+        static const vector<SDL_FPoint> table = [] {
+            vector<SDL_FPoint> points(CIRCLE_STEPS + 1);
+            for (int i = 0; i <= CIRCLE_STEPS; i++) {
+                double angle = 2 * M_PI * i / CIRCLE_STEPS - M_PI / 2;
+                points[i] = {static_cast<float>(cos(angle)), static_cast<float>(sin(angle))};
+            }
+            return points;
+        }();
+        return table;
+    }
+   
+    // Unit vector `turns` of the way round, interpolated between table steps
+    static SDL_FPoint direction(double turns) {
+        const vector<SDL_FPoint>& table = unitCircle();
+        double position = min(max(turns, 0.0), 1.0) * CIRCLE_STEPS;
+        int step = min(static_cast<int>(position), CIRCLE_STEPS - 1);
+        float t = static_cast<float>(position - step);
+        SDL_FPoint a = table[step], b = table[step + 1];
+        SDL_FPoint p = {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t};
+        float length = sqrt(p.x * p.x + p.y * p.y);
+        return {p.x / length, p.y / length};
+    }
+   
+    void addVertex(SDL_FPoint dir, float distance, SDL_Color color) {
+        SDL_Vertex v;
+        v.position = {centerX + dir.x * distance, centerY + dir.y * distance};
+        v.color = color;
+        v.tex_coord = {0.0f, 0.0f};
+        vertices.push_back(v);
+    }
+   
+    void rebuildGeometry() {
+        const vector<SDL_FPoint>& table = unitCircle();
+        vertices.clear();
+        indices.clear();
+        labels.clear();
+        geometryDirty = false;
+       
+        int64_t total = 0;
+        for (const auto& pair : data) total += max(pair.second, 0);
+        double scale = total > 0 ? 1.0 / total : 0.0;
+       
+        int64_t before = 0;
+        vector<SDL_FPoint> rim;
+        for (size_t i = 0; i < data.size(); ++i) {
+            const auto& pair = data[i];
+            int value = max(pair.second, 0);
+            SDL_Color color = colors[i % colors.size()];
+            double first = before * scale;
+            before += value;
+            double last = before * scale;
+           
+            // Label sits beyond the middle of the slice, value text below it
+            SDL_FPoint mid = direction((first + last) / 2);
+            float labelDistance = radius * 1.3f;
+            int percentage = static_cast<int>(value * 100.0 * scale);
+            labels.push_back({centerX + static_cast<int>(labelDistance * mid.x),
+                              centerY + static_cast<int>(labelDistance * mid.y),
+                              Utils::formatDuration(pair.second) + " (" + to_string(percentage) + "%)",
+                              pair.first + ": " + Utils::formatDuration(pair.second)});
+            if (last <= first) continue;
+           
+            // Rim: the exact slice ends plus every table step between them
+            rim.clear();
+            rim.push_back(direction(first));
+            for (int step = static_cast<int>(first * CIRCLE_STEPS) + 1; step < last * CIRCLE_STEPS; step++)
+                rim.push_back(table[step]);
+            rim.push_back(direction(last));
+           
+            SDL_Color faded = {color.r, color.g, color.b, 0};
+            int centre = static_cast<int>(vertices.size());
+            addVertex({0.0f, 0.0f}, 0.0f, color);
+            for (const SDL_FPoint& dir : rim) {
+                addVertex(dir, static_cast<float>(radius), color);
+                addVertex(dir, radius + FEATHER, faded);
+            }
+            for (size_t k = 0; k + 1 < rim.size(); k++) {
+                int inner = centre + 1 + 2 * static_cast<int>(k), outer = inner + 1;
+                indices.insert(indices.end(), {centre, inner, inner + 2,
+                                               inner, outer, inner + 2,
+                                               inner + 2, outer, outer + 2});
+            }
+        }
+    }
+
+public:
+    SDLPieChart(SDL_Renderer* renderer, TextCache& text, int centerX, int centerY, int radius)
+        : renderer(renderer), text(text), centerX(centerX), centerY(centerY), radius(radius), title("Pie Chart") {
+        // Initialize default colors
+        colors = {
+            {255, 0, 0, 255},     // Red
+            {0, 255, 0, 255},     // Green
+            {0, 0, 255, 255},     // Blue
+            {255, 255, 0, 255},   // Yellow
+            {255, 0, 255, 255},   // Magenta
+            {0, 255, 255, 255},   // Cyan
+            {255, 128, 0, 255},   // Orange
+            {128, 0, 255, 255},   // Purple
+            {0, 128, 255, 255},   // Light blue
+            {128, 255, 0, 255}    // Lime
+        };
+    }
+    //To  add a data point to the pie chart
+    void addDataPoint(const string& label, int value) {
+        data.push_back(make_pair(label, value));
+        geometryDirty = true;
+    }
+    // Clear all data
+    void clearData() {
+        data.clear();
+        geometryDirty = true;
+    }
+   
+    // Set chart title
+    void setTitle(const string& newTitle) {
+        title = newTitle;
+    }
+   
+    // Render the pie chart
+    void render() {
+        if (data.empty()) return;
+       
+        if (geometryDirty) rebuildGeometry();
+       
+        // Draw title
+        SDL_Color titleColor = {255, 255, 255, 255};
+        renderText(text, title, centerX, centerY - radius - 30, titleColor, true);
+       
+        // Draw every slice in one call; blending fades the rim
+        if (!indices.empty()) {
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+            SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size()));
+        }
+       
+        // Labels with value and percentage
+        for (size_t i = 0; i < labels.size(); ++i) {
+            SDL_Color color = colors[i % colors.size()];
+            renderText(text, data[i].first, labels[i].x, labels[i].y, color, true);
+            renderText(text, labels[i].valueText, labels[i].x, labels[i].y + 20, color, true);
+        }
+       
+        // Draw legend
+        int legendX = centerX + radius + 50;
+        int legendY = centerY - radius;
+        int legendWidth = 200;
+        int legendHeight = data.size() * 25 + 40;
+       
+        // Draw legend background
+        SDL_Rect legendRect = {legendX, legendY, legendWidth, legendHeight};
+        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+        SDL_RenderFillRect(renderer, &legendRect);
+        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
+        SDL_RenderDrawRect(renderer, &legendRect);
+       
+        // Draw legend title
+        renderText(text, "Legend", legendX + legendWidth / 2, legendY + 20, titleColor, true);
+       
+        // Draw legend items
+        for (size_t i = 0; i < labels.size(); i++) {
+            SDL_Color color = colors[i % colors.size()];
+            int itemY = legendY + 50 + i * 25;
+           
+            // Draw color box
+            SDL_Rect colorRect = {legendX + 20, itemY, 15, 15};
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRect(renderer, &colorRect);
+           
+            // Draw label and value
+            renderText(text, labels[i].legendText, legendX + 45, itemY + 7, titleColor, false);
+        }
+    }
+};
+
+// ----------- VISUALIZATION CLASS (to show visulation on terminal only)------
+class Visualization {
+protected:
+    User* user;
+    TextBuffer content;
+    int width;
+   
+    int barLength(int value, int maxValue, int maxBars = 50) const {
+        if (maxValue <= 0) return 0;
+        return static_cast<int>((static_cast<double>(value) / maxValue) * maxBars);
+    }
+   
+    // Framed, centred title shared by the text charts
+    void writeHeader(const string& title) {
+        size_t inner = width - 2;
+        size_t before = (inner - title.length()) / 2, after = (inner - title.length() + 1) / 2;
+        content << '+';
+        content.repeat('-', inner) << "+\n|";
+        content.repeat(' ', max<size_t>(before, 1)) << title;
+        content.repeat(' ', max<size_t>(after, 1)) << "|\n+";
+        content.repeat('-', inner) << "+\n";
+    }
+   
+    void writeFooter() {
+        content << '+';
+        content.repeat('-', width - 2) << "+\n";
+    }
+
+public:
+    Visualization(User* user, int width = 80) : user(user), width(width) {}
+    virtual ~Visualization() {}
+   
+    virtual void render() = 0;
+    const string& getContent() const { return content.str(); }
+   
+    void saveToFile(const string& filename) {
+        ofstream file(filename);
+        if (file.is_open()) {
+            content.writeTo(file);
+            file.close();
+            cout << "Visualization saved to " << filename << endl;
+        }
+    }
+};
+
+class BarChart : public Visualization {
+private:
+    string title;
+    vector<pair<string, int>> data;
+
+public:
+    BarChart(User* user, const string& title) : Visualization(user, 80), title(title) {}
+   
+    void addDataPoint(const string& label, int value) {
+        data.push_back(make_pair(label, value));
+    }
+   
+    void render() override {
+        int maxValue = 0;
+        for (const auto& pair : data)
+            if (pair.second > maxValue) maxValue = pair.second;
+       
+        content.clear();
+        writeHeader(title);
+        for (const auto& pair : data) {
+            content << "| ";
+            content.column(string_view(pair.first).substr(0, 15), 15) << " | ";
+            content.repeat('|', barLength(pair.second, maxValue, width - 30)) << ' ';
+            size_t field = content.size();
+            content.duration(pair.second).alignRight(field, 8) << " |\n";
+        }
+        writeFooter();
+        content.writeTo(cout);
+        cout << endl;
+    }
+};
+
+class PieChart : public Visualization {
+private:
+    string title;
+    vector<pair<string, int>> data;
+   
+    // SDL-related members
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    unique_ptr<TextCache> textCache;   // glyph atlas and laid-out strings for this renderer
+    bool sdlInitialized;
+
+public:
+    PieChart(User* user, const string& title)
+        : Visualization(user, 80), title(title), window(nullptr), renderer(nullptr), font(nullptr), sdlInitialized(false) {}
+   
+    ~PieChart() {
+        // Clean up SDL resources if initialized
+        if (sdlInitialized) {
+            textCache.reset();   // its textures belong to the renderer
+            if (font) TTF_CloseFont(font);
+            if (renderer) SDL_DestroyRenderer(renderer);
+            if (window) SDL_DestroyWindow(window);
+            TTF_Quit();
+            SDL_Quit();
+        }
+    }
+   
+    void addDataPoint(const string& label, int value) {
+        data.push_back(make_pair(label, value));
+    }
+   
+    // Text-based rendering for console output
+    void renderTextBased() {
+        int total = 0;
+        for (const auto& pair : data) total += pair.second;
+       
+        content.clear();
+        writeHeader(title);
+        for (const auto& pair : data) {
+            double percentage = (total > 0) ? (pair.second * 100.0 / total) : 0.0;
+           
+            content << "| ";
+            content.column(string_view(pair.first).substr(0, 15), 15) << " | ";
+            content.repeat('|', barLength(pair.second, total, width - 40)) << ' ';
+            size_t field = content.size();
+            content.decimal(percentage, 1).alignRight(field, 5) << "% | ";
+            field = content.size();
+            content.duration(pair.second).alignRight(field, 8) << " |\n";
+        }
+        writeFooter();
+        content.writeTo(cout);
+        cout << endl;
+    }
+   
+    // Initialize SDL for graphical rendering
+    bool initSDL() {
+        // Initialize SDL
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << endl;
+            return false;
+        }
+       
+       
+        if (TTF_Init() < 0) {
+            cerr << "SDL_ttf could not initialize! TTF_Error: " << TTF_GetError() << endl;
+            SDL_Quit();
+            return false;
+        }
+       
+        // to Create window
+        window = SDL_CreateWindow(("Study Time - " + title).c_str(),
+                                 SDL_WINDOWPOS_UNDEFINED,
+                                 SDL_WINDOWPOS_UNDEFINED,
+                                 800, 600,
+                                 SDL_WINDOW_SHOWN);
+        if (!window) {
+            cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << endl;
+            TTF_Quit();
+            SDL_Quit();
+            return false;
+        }
+       
+
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        if (!renderer) {
+            cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
+            SDL_DestroyWindow(window);
+            TTF_Quit();
+            SDL_Quit();
+            return false;
+        }
+        //to  Load font
+        font = TTF_OpenFont("/System/Library/Fonts/Supplemental/Arial.ttf", 16);
+        if (!font) {
+            cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << endl;
+                  }
+        textCache = make_unique<TextCache>(renderer, font);
+       
+        sdlInitialized = true;
+        return true;
+    }
+    // Render the pie chart using SDL
+    void renderSDL() {
+        if (!sdlInitialized && !initSDL()) {
+            cerr << "Failed to initialize SDL. Falling back to text-based rendering." << endl;
+            renderTextBased();
+            return;
+        }
+        // to Create pie chart
+        SDLPieChart pieChart(renderer, *textCache, 400, 300, 150);
+        pieChart.setTitle(title);
+        for (const auto& pair : data) {
+            pieChart.addDataPoint(pair.first, pair.second);
+        }
+     
+        const string instructions = "Press ESC or ENTER to return";
+       
+        // Main loop flag
+        bool quit = false;
+        // Event handler
+        SDL_Event e;
+        while (!quit) {
+            // Handle events
+            while (SDL_PollEvent(&e) != 0) {
+                if (e.type == SDL_QUIT) {
+                    quit = true;
+                }
+                else if (e.type == SDL_KEYDOWN) {
+                    if (e.key.keysym.sym == SDLK_ESCAPE || e.key.keysym.sym == SDLK_RETURN) {
+                        quit = true;
+                    }
+                }
+            }
+           
+            // Clear screen
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+           
+            // Render pie chart
+            pieChart.render();
+           
+            // Render instructions
+            SDL_Color textColor = {255, 255, 255, 255};
+            renderText(*textCache, instructions, 400, 550, textColor, true);
+           
+            // Update screen
+            SDL_RenderPresent(renderer);
+            textCache->endFrame();
+           
+            // Cap to 60 FPS
+            SDL_Delay(16);
+        }
+    }
+   
+    void render() override {
+        // First generate the text-based content for saving to file
+        renderTextBased();
+       
+        // Then render the graphical version if requested
+        cout << "Would you like to view the pie chart graphically? (y/n): ";
+        string response;
+        getline(cin, response);
+       
+        if (response == "y" || response == "Y") {
+            renderSDL();
+        }
+    }
+};
+
+// -------------------- LIVE SESSION TIMER --------------------
+// Study and break time measured on steady_clock, so wall-clock adjustments do not
+// skew them. Start, pause, resume and stop are also stamped in wall-clock
+// milliseconds for the session's timeline. The status ticker reads it from its own
+// thread, hence the lock.
+class SessionTimer {
+public:
+    using Clock = chrono::steady_clock;
+
+private:
+    mutable mutex lock;
+    Clock::time_point startedAt, pausedAt, stoppedAt;
+    Clock::duration breaks{};
+    bool paused = false, stopped = false;
+    chrono::system_clock::time_point wallStart;
+    vector<int64_t> marks;
+   
+    int64_t wallMillis(Clock::time_point t) const {
+        auto wall = wallStart + chrono::duration_cast<chrono::system_clock::duration>(t - startedAt);
+        return chrono::duration_cast<chrono::milliseconds>(wall.time_since_epoch()).count();
+    }
+   
+    Clock::time_point endOf(Clock::time_point now) const { return stopped ? stoppedAt : now; }
+   
+    Clock::duration studiedAt(Clock::time_point now) const {
+        return endOf(now) - startedAt - breaks - (paused ? endOf(now) - pausedAt : Clock::duration::zero());
+    }
+   
+    Clock::duration breaksAt(Clock::time_point now) const {
+        return breaks + (paused ? endOf(now) - pausedAt : Clock::duration::zero());
+    }
+
+public:
+    void start() {
+        lock_guard<mutex> guard(lock);
+        startedAt = Clock::now();
+        wallStart = chrono::system_clock::now();
+        breaks = Clock::duration::zero();
+        paused = stopped = false;
+        marks.assign(1, wallMillis(startedAt));
+    }
+   
+    void pause() {
+        lock_guard<mutex> guard(lock);
+        if (paused || stopped) return;
+        pausedAt = Clock::now();
+        paused = true;
+        marks.push_back(wallMillis(pausedAt));
+    }
+   
+    void resume() {
+        lock_guard<mutex> guard(lock);
+        if (!paused || stopped) return;
+        Clock::time_point now = Clock::now();
+        breaks += now - pausedAt;
+        paused = false;
+        marks.push_back(wallMillis(now));
+    }
+   
+    void stop() {
+        lock_guard<mutex> guard(lock);
+        if (stopped) return;
+        stoppedAt = Clock::now();
+        if (paused) {
+            breaks += stoppedAt - pausedAt;
+            paused = false;
+            marks.push_back(wallMillis(stoppedAt));
+        }
+        stopped = true;
+        marks.push_back(wallMillis(stoppedAt));
+    }
+   
+    bool isPaused() const { lock_guard<mutex> guard(lock); return paused; }
+    Clock::duration studied() const { lock_guard<mutex> guard(lock); return studiedAt(Clock::now()); }
+    Clock::duration onBreak() const { lock_guard<mutex> guard(lock); return breaksAt(Clock::now()); }
+   
+    // Time until whichever counter is running next reaches a whole second
+    Clock::duration untilNextSecond() const {
+        lock_guard<mutex> guard(lock);
+        Clock::duration running = paused ? breaksAt(Clock::now()) : studiedAt(Clock::now());
+        return chrono::seconds(1) - running % chrono::seconds(1);
+    }
+   
+    // Whole seconds for the session table, which keeps second resolution
+    time_t startTime() const { lock_guard<mutex> guard(lock); return Utils::floorDiv(marks.front(), 1000); }
+    time_t stopTime() const { lock_guard<mutex> guard(lock); return Utils::floorDiv(marks.back(), 1000); }
+    int breakSeconds() const {
+        lock_guard<mutex> guard(lock);
+        return static_cast<int>(chrono::round<chrono::seconds>(breaksAt(Clock::now())).count());
+    }
+   
+    vector<int64_t> timeline() const { lock_guard<mutex> guard(lock); return marks; }
+};
+
+// -------------------- STATUS TICKER --------------------
+// Redraws a status line in place while the input thread sits in getline: the
+// cursor is saved, moved up to the line, the line rewritten and the cursor put
+// back. Between redraws the thread sleeps on a condition variable until the
+// drawn counter next changes, so an idle screen costs one wakeup per second.
+// Only draws on a terminal; piped output keeps the static screen.
+class StatusTicker {
+public:
+    // Appends the line's text and returns how long it stays current
+    using Draw = function<SessionTimer::Clock::duration(TextBuffer&)>;
+
+private:
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    Draw draw;
+    int linesUp = 0;
+    uint64_t generation = 0;   // bumped by show/hide so a sleeping tick notices
+    bool stopping = false;
+    bool terminal = isatty(STDOUT_FILENO) != 0;
+   
+    void run() {
+        unique_lock<mutex> guard(lock);
+        TextBuffer out;
+        while (!stopping) {
+            if (!draw) {
+                wake.wait(guard);
+                continue;
+            }
+            out.clear();
+            out << "\0337\033[" << linesUp << "A\r";
+            SessionTimer::Clock::duration delay = draw(out);
+            out << "\033[K\0338";
+            {
+                lock_guard<mutex> console(consoleMutex);
+                ssize_t written = ::write(STDOUT_FILENO, out.str().data(), out.size());
+                (void)written;
+            }
+   
+            uint64_t seen = generation;
+            SessionTimer::Clock::time_point next = SessionTimer::Clock::now() + delay;
+            wake.wait_until(guard, next, [&] { return stopping || generation != seen; });
+        }
+    }
+
+public:
+    ~StatusTicker() { stop(); }
+   
+    // Starts redrawing the line `lines` rows above the cursor. Anything still in
+    // cout's buffer goes out first, or it would be flushed over a redraw.
+    void show(int lines, Draw drawLine) {
+        if (!terminal) return;
+        {
+            lock_guard<mutex> console(consoleMutex);
+            cout.flush();
+        }
+        {
+            lock_guard<mutex> guard(lock);
+            draw = move(drawLine);
+            linesUp = lines;
+            generation++;
+            if (!worker.joinable()) {
+                stopping = false;
+                worker = thread(&StatusTicker::run, this);
+            }
+        }
+        wake.notify_one();
+    }
+   
+    // Once this returns no redraw is in progress or pending
+    void hide() {
+        {
+            lock_guard<mutex> guard(lock);
+            draw = nullptr;
+            generation++;
+        }
+        wake.notify_one();
+    }
+   
+    void stop() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+            draw = nullptr;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+};
+
+StatusTicker statusTicker;
+
+// ------------------ BREAK TIME FUNCTIONS ------------------------
+// Function to play background music during breaks
+void playBackgroundMusic(const char* musicFile) {
+    // Initialize SDL_mixer
+    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+        lock_guard<mutex> console(consoleMutex);   // the break ticker is drawing
+        cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << endl;
+        return;
+    }
+   
+    // Load music file
+    backgroundMusic = Mix_LoadMUS(musicFile);
+    if (!backgroundMusic) {
+        {
+            lock_guard<mutex> console(consoleMutex);
+            cerr << "Failed to load background music! SDL_mixer Error: " << Mix_GetError() << endl;
+        }
+        Mix_CloseAudio();
+        return;
+    }
+   
+    // Play music on loop
+    Mix_PlayMusic(backgroundMusic, -1);
+   
+    // Keep thread alive while break is active
+    {
+        unique_lock<mutex> guard(breakMutex);
+        breakEnded.wait(guard, [] { return !breakActive; });
+    }
+   
+    // Stop and clean up when break ends
+    Mix_HaltMusic();
+    Mix_FreeMusic(backgroundMusic);
+    backgroundMusic = nullptr;
+    Mix_CloseAudio();
+}
+// Utility functions
+void clearScreen() { system("clear"); }
+void pauseExecution() {
+    cout << "\nPress Enter to continue...";
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+// Function to handle break time; the timer is paused until Enter is pressed
+void takeBreak(SessionTimer& timer) {
+    timer.pause();
+    clearScreen();
+    cout << "===== BREAK TIME =====" << endl;
+    cout << "Your study session is paused. Enjoy your break!" << endl;
+    cout << "Playing relaxing music..." << endl;
+   
+    auto drawBreak = [&timer](TextBuffer& out) {
+        out << "Break time: ";
+        out.clock(chrono::duration_cast<chrono::seconds>(timer.onBreak()).count());
+        return timer.untilNextSecond();
+    };
+    TextBuffer screen;
+    drawBreak(screen);
+    screen << "\n\nPress Enter to end your break and resume studying...\n";
+    screen.writeTo(cout);
+    statusTicker.show(3, drawBreak);
+   
+    // Set break as active
+    breakActive = true;
+   
+    // Start music in a separate thread
+    musicThread = thread(playBackgroundMusic, "/Users/chiragsingh/Downloads/blue\ bird\ \(Naruto\ but\ is\ it\ okay\ if\ it\'s\ lofi\ hiphop_\).mp3");
+   
+    // Wait for user to press Enter
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    statusTicker.hide();
+    timer.resume();
+   
+    // End break
+    {
+        lock_guard<mutex> guard(breakMutex);
+        breakActive = false;
+    }
+    breakEnded.notify_all();
+   
+    // Wait for music thread to finish
+    if (musicThread.joinable()) {
+        musicThread.join();
+    }
+   
+    cout << "Break ended. Resuming study session..." << endl;
+    pauseExecution();
+}
+
+// -------------------- USER REGISTRY (users.db + users.idx) --------------------
+// users.db is an append-only log of account records. users.idx is an on-disk
+// open-addressing hash table (username hash -> record offset) probed with pread,
+// so startup reads one header and a lookup touches a few slots plus one record.
+class UserRegistry {
+public:
+    struct Record {
+        int id = 0;
+        string username;
+        string fullName;
+        User::Credentials credentials;
+    };
+
+private:
+    static constexpr char MAGIC[4] = {'S', 'S', 'U', 'I'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t MIN_CAPACITY = 1024;
+
+    struct IndexHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t capacity;       // number of slots, a power of two
+        uint64_t count;
+        uint64_t indexedBytes;   // prefix of users.db covered by the table
+        int32_t nextUserId;
+        uint32_t reserved;
+    };
+
+    struct Slot {
+        uint64_t hash;     // 0 marks an empty slot
+        uint64_t offset;   // record position in users.db
+    };
+
+    string idxPath;
+    int dbFd = -1;
+    int idxFd = -1;
+    IndexHeader header = {};
+
+    static uint64_t hashName(const string& username) {
+        uint64_t h = 1469598103934665603ULL;   // FNV-1a
+        for (unsigned char c : username) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h ? h : 1;
+    }
+
+    static off_t slotPosition(uint64_t slot) { return sizeof(IndexHeader) + slot * sizeof(Slot); }
+
+    // Smallest body: the id and four empty length-prefixed strings
+    static constexpr uint32_t MIN_RECORD_BODY = sizeof(int32_t) + 4 * sizeof(int32_t);
+
+    bool readRecord(uint64_t offset, Record& out, uint32_t* recordSize = nullptr) const {
+        uint32_t length = 0;
+        if (pread(dbFd, &length, sizeof(length), offset) != sizeof(length)) return false;
+        // A damaged length must not size the allocation; it can be at most what the file holds
+        struct stat st;
+        if (fstat(dbFd, &st) != 0 || length < MIN_RECORD_BODY
+            || offset + sizeof(length) + length > static_cast<uint64_t>(st.st_size)) return false;
+        string body(length, '\0');
+        if (pread(dbFd, &body[0], length, offset + sizeof(length)) != static_cast<ssize_t>(length)) return false;
+        ByteReader in(body.data(), body.size());
+        out.id = in.i32();
+        out.username = in.str();
+        out.fullName = in.str();
+        out.credentials.salt = in.str();
+        out.credentials.hash = in.str();
+        if (recordSize) *recordSize = sizeof(length) + length;
+        return in.ok();
+    }
+
+    bool writeHeader() { return pwrite(idxFd, &header, sizeof(header), 0) == sizeof(header); }
+
+    bool placeSlot(uint64_t hash, uint64_t offset) {
+        uint64_t mask = header.capacity - 1;
+        for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot slot;
+            if (pread(idxFd, &slot, sizeof(slot), slotPosition(i)) != sizeof(slot)) return false;
+            if (slot.hash == 0) {
+                slot = {hash, offset};
+                return pwrite(idxFd, &slot, sizeof(slot), slotPosition(i)) == sizeof(slot);
+            }
+        }
+    }
+
+    // Builds a table of the given capacity in a temp file and renames it over users.idx
+    bool writeTable(const vector<Slot>& entries, uint64_t capacity) {
+        vector<Slot> table(capacity, Slot{0, 0});
+        uint64_t mask = capacity - 1;
+        for (const auto& entry : entries) {
+            uint64_t i = entry.hash & mask;
+            while (table[i].hash != 0) i = (i + 1) & mask;
+            table[i] = entry;
+        }
+        header.capacity = capacity;
+        header.count = entries.size();
+
+        string tmpPath = idxPath + ".tmp";
+        int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        ssize_t tableBytes = capacity * sizeof(Slot);
+        bool written = pwrite(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                       pwrite(fd, table.data(), tableBytes, sizeof(header)) == tableBytes &&
+                       fsync(fd) == 0;
+        if (!written || rename(tmpPath.c_str(), idxPath.c_str()) != 0) {
+            ::close(fd);
+            unlink(tmpPath.c_str());
+            return false;
+        }
+        if (idxFd >= 0) ::close(idxFd);
+        idxFd = fd;
+        return Checkpoint::syncDirectoryOf(idxPath);
+    }
+
+    // Doubles the table once it is 70% full, keeping probe sequences short
+    bool grow() {
+        vector<Slot> table(header.capacity);
+        ssize_t tableBytes = header.capacity * sizeof(Slot);
+        if (pread(idxFd, table.data(), tableBytes, sizeof(header)) != tableBytes) return false;
+        vector<Slot> entries;
+        entries.reserve(header.count);
+        for (const auto& slot : table)
+            if (slot.hash != 0) entries.push_back(slot);
+        return writeTable(entries, header.capacity * 2);
+    }
+
+    bool addToIndex(const Record& record, uint64_t offset) {
+        if ((header.count + 1) * 10 > header.capacity * 7 && !grow()) return false;
+        if (!placeSlot(hashName(record.username), offset)) return false;
+        header.count++;
+        if (record.id >= header.nextUserId) header.nextUserId = record.id + 1;
+        return true;
+    }
+
+    // Indexes records past `offset`: all of them when rebuilding, or the few a crash
+    // left between an append and its slot write. A torn last record is cut off.
+    bool indexFrom(uint64_t offset) {
+        struct stat info;
+        if (fstat(dbFd, &info) != 0) return false;
+        while (offset < static_cast<uint64_t>(info.st_size)) {
+            Record record;
+            uint32_t size = 0;
+            if (!readRecord(offset, record, &size)) {
+                if (ftruncate(dbFd, offset) != 0) return false;
+                break;
+            }
+            if (!addToIndex(record, offset)) return false;
+            offset += size;
+        }
+        header.indexedBytes = offset;
+        return writeHeader();
+    }
+
+public:
+    UserRegistry() = default;
+    UserRegistry(const UserRegistry&) = delete;
+    UserRegistry& operator=(const UserRegistry&) = delete;
+    ~UserRegistry() {
+        if (dbFd >= 0) ::close(dbFd);
+        if (idxFd >= 0) ::close(idxFd);
+    }
+
+    bool open(const string& dbFile, const string& idxFile) {
+        idxPath = idxFile;
+        dbFd = ::open(dbFile.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (dbFd < 0) return false;
+
+        idxFd = ::open(idxFile.c_str(), O_RDWR);
+        bool valid = idxFd >= 0 && pread(idxFd, &header, sizeof(header), 0) == sizeof(header) &&
+                     memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                     header.capacity >= MIN_CAPACITY && (header.capacity & (header.capacity - 1)) == 0;
+        if (valid) return indexFrom(header.indexedBytes);
+
+        // Missing or damaged index: rebuild it from the record log
+        header = {};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.nextUserId = 1;
+        if (!writeTable({}, MIN_CAPACITY)) return false;
+        return indexFrom(0);
+    }
+
+    bool find(const string& username, Record& out) const {
+        if (idxFd < 0) return false;
+        uint64_t hash = hashName(username);
+        uint64_t mask = header.capacity - 1;
+        for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot slot;
+            if (pread(idxFd, &slot, sizeof(slot), slotPosition(i)) != sizeof(slot) || slot.hash == 0) return false;
+            if (slot.hash == hash && readRecord(slot.offset, out) && out.username == username) return true;
+        }
+    }
+
+    bool contains(const string& username) const {
+        Record record;
+        return find(username, record);
+    }
+
+    bool insert(const Record& record) {
+        if (dbFd < 0 || idxFd < 0) return false;
+        ByteWriter body;
+        body.i32(record.id).str(record.username).str(record.fullName)
+            .str(record.credentials.salt).str(record.credentials.hash);
+        ByteWriter framed;
+        framed.i32(static_cast<int32_t>(body.bytes().size()));
+        vector<char> bytes = framed.bytes();
+        bytes.insert(bytes.end(), body.bytes().begin(), body.bytes().end());
+
+        // The record lands at the real end of users.db. Bytes past indexedBytes (a crash
+        // before the header was updated) are indexed or cut off first.
+        off_t end = lseek(dbFd, 0, SEEK_END);
+        if (end < 0) return false;
+        if (static_cast<uint64_t>(end) != header.indexedBytes) {
+            if (!indexFrom(header.indexedBytes)) return false;
+            if ((end = lseek(dbFd, 0, SEEK_END)) < 0) return false;
+        }
+        uint64_t offset = end;
+        if (write(dbFd, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size())) {
+            if (ftruncate(dbFd, offset) != 0) cerr << "Could not cut off a partial account record." << endl;
+            return false;
+        }
+        if (!addToIndex(record, offset)) return false;
+        header.indexedBytes = offset + bytes.size();
+        return writeHeader();
+    }
+
+    int nextUserId() const { return header.nextUserId > 0 ? header.nextUserId : 1; }
+    size_t size() const { return header.count; }
+
+    // Visits every account in registration order by walking the record log
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        Record record;
+        uint32_t size = 0;
+        for (uint64_t offset = 0; offset < header.indexedBytes && readRecord(offset, record, &size); offset += size)
+            visit(record);
+    }
+};
+
+// -------------------- DATA LAYOUT --------------------
+// User directories are sharded as data/<shard>/user_<id>, with the shard taken from a
+// hash of the id, so no directory holds more than a few thousand entries even with
+// hundreds of thousands of users. Directories from the old flat layout
+// (data/user_<id>) are moved into their shard the first time they are touched.
+class DataLayout {
+private:
+    static constexpr int SHARD_COUNT = 256;
+
+public:
+    static string shardOf(int userId) {
+        uint32_t mixed = static_cast<uint32_t>(userId) * 2654435761u;   // spread sequential ids
+        char shard[3];
+        snprintf(shard, sizeof(shard), "%02x", (mixed >> 24) % SHARD_COUNT);
+        return shard;
+    }
+
+    // Resolved (and created) once per user, so repeat saves cost no extra syscalls
+    static string userDir(int userId) {
+        static mutex dirsMutex;
+        static unordered_map<int, string> knownDirs;
+        lock_guard<mutex> lock(dirsMutex);
+        auto it = knownDirs.find(userId);
+        if (it != knownDirs.end()) return it->second;
+
+        string dir = "data/" + shardOf(userId) + "/user_" + to_string(userId);
+        error_code ec;
+        if (!fs::exists(dir, ec)) {
+            fs::create_directories("data/" + shardOf(userId), ec);
+            string legacyDir = "data/user_" + to_string(userId);
+            if (fs::exists(legacyDir, ec)) fs::rename(legacyDir, dir, ec);
+            if (!fs::exists(dir, ec)) fs::create_directories(dir, ec);
+        }
+        return knownDirs.emplace(userId, dir).first->second;
+    }
+};
+
+// -------------------- BACKGROUND PERSISTENCE --------------------
+// All disk writes happen on one worker thread. Journal records for a user that
+// arrive within the coalescing window go down as a single append, and snapshots
+// queue behind them, so the on-disk order always matches the order of mutations.
+class PersistenceWorker {
+private:
+    struct Task {
+        bool isSnapshot = false;
+        vector<char> journalBytes;
+        User::Snapshot snapshot;
+    };
+
+    mutex mtx;
+    condition_variable wake;
+    condition_variable drained;
+    unordered_map<int, deque<Task>> pending;   // per-user FIFO
+    unordered_set<int> compactionWanted;   // a journal append failed
+    chrono::milliseconds window;
+    int flushWaiters = 0;
+    bool busy = false;
+    bool stopping = false;
+    bool running = true;
+    thread worker;
+
+    void writeTasks(int userId, deque<Task>& tasks) {
+        string dir = DataLayout::userDir(userId);
+        for (auto& task : tasks) {
+            if (task.isSnapshot) {
+                if (task.snapshot.write(dir + "/sessions.dat", dir + "/todo.dat", dir + "/search.idx") &&
+                    Journal::truncate(dir + "/journal.log")) {
+                    lock_guard<mutex> lock(mtx);
+                    compactionWanted.erase(userId);
+                } else {
+                    cerr << "Could not save data for user " << userId << endl;
+                }
+                continue;
+            }
+            // A failed append is repaired by the next full snapshot
+            if (Journal::append(dir + "/journal.log", task.journalBytes) < 0) {
+                lock_guard<mutex> lock(mtx);
+                compactionWanted.insert(userId);
+            }
+        }
+    }
+
+    void run() {
+        unique_lock<mutex> lock(mtx);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) break;   // stopping with nothing left
+            // Let further mutations pile up unless someone is waiting on the data
+            if (!stopping && flushWaiters == 0)
+                wake.wait_for(lock, window, [this] { return stopping || flushWaiters > 0; });
+
+            unordered_map<int, deque<Task>> batch;
+            batch.swap(pending);
+            busy = true;
+            lock.unlock();
+            for (auto& entry : batch) writeTasks(entry.first, entry.second);
+            lock.lock();
+            busy = false;
+            if (pending.empty()) drained.notify_all();
+        }
+        running = false;
+        drained.notify_all();
+    }
+
+public:
+    explicit PersistenceWorker(chrono::milliseconds window)
+        : window(window), worker(&PersistenceWorker::run, this) {}
+    ~PersistenceWorker() { stop(); }
+
+    void setWindow(chrono::milliseconds newWindow) {
+        lock_guard<mutex> lock(mtx);
+        window = newWindow;
+    }
+
+    void enqueueJournal(int userId, const vector<char>& record) {
+        lock_guard<mutex> lock(mtx);
+        deque<Task>& tasks = pending[userId];
+        if (tasks.empty() || tasks.back().isSnapshot) tasks.emplace_back();
+        vector<char>& bytes = tasks.back().journalBytes;
+        bytes.insert(bytes.end(), record.begin(), record.end());
+        wake.notify_one();
+    }
+
+    void enqueueSnapshot(int userId, User::Snapshot snapshot) {
+        lock_guard<mutex> lock(mtx);
+        Task task;
+        task.isSnapshot = true;
+        task.snapshot = move(snapshot);
+        pending[userId].push_back(move(task));
+        wake.notify_one();
+    }
+
+    // True once a failed append left this user's journal needing a snapshot
+    bool takeCompactionRequest(int userId) {
+        lock_guard<mutex> lock(mtx);
+        return compactionWanted.erase(userId) > 0;
+    }
+
+    // Blocks until everything queued so far is on disk
+    void flush() {
+        unique_lock<mutex> lock(mtx);
+        flushWaiters++;
+        wake.notify_one();
+        drained.wait(lock, [this] { return (pending.empty() && !busy) || !running; });
+        flushWaiters--;
+    }
+
+    void stop() {
+        {
+            lock_guard<mutex> lock(mtx);
+            if (stopping) return;
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+};
+
+// --------------------------FILE MANAGEMENT --------------------
+class FileManager {
+private:
+    static PersistenceWorker& worker() {
+        static PersistenceWorker instance(COALESCE_WINDOW);
+        return instance;
+    }
+   
+    // Journal bytes queued since each user's last snapshot; only the menu thread touches it
+    static unordered_map<int, long>& journalSizes() {
+        static unordered_map<int, long> sizes;
+        return sizes;
+    }
+
+public:
+    // Journal size at which it is folded back into the snapshot
+    static constexpr long JOURNAL_COMPACT_BYTES = 64 * 1024;
+    // How long the worker waits for more mutations before writing
+    static constexpr chrono::milliseconds COALESCE_WINDOW{250};
+
+    static void setCoalesceWindow(chrono::milliseconds window) { worker().setWindow(window); }
+
+    // Queue a full snapshot; the journal is emptied once it is on disk
+    static bool saveUserData(int userId, User* user) {
+        if (!user) return false;
+        worker().enqueueSnapshot(userId, user->snapshot());
+        journalSizes()[userId] = 0;
+        return true;
+    }
+   
+    static bool loadUserData(int userId, User* user) {
+        if (!user) return false;
+        worker().flush();   // never read behind our own queued writes
+        string userDir = DataLayout::userDir(userId);
+        bool loaded = user->loadUserData(userDir + "/sessions.dat", userDir + "/todo.dat", userDir + "/search.idx");
+        Journal::replay(userDir + "/journal.log", *user);
+        error_code ec;
+        uintmax_t size = fs::file_size(userDir + "/journal.log", ec);
+        journalSizes()[userId] = ec ? 0 : static_cast<long>(size);
+        return loaded;
+    }
+   
+    // Record a single mutation; the one that takes the journal past JOURNAL_COMPACT_BYTES
+    // (or follows a failed append) queues a fresh snapshot right behind it
+    static bool logMutation(int userId, User* user, const vector<char>& record) {
+        if (!user) return false;
+        worker().enqueueJournal(userId, record);
+        long& size = journalSizes()[userId];
+        size += static_cast<long>(record.size());
+        if (size > JOURNAL_COMPACT_BYTES || worker().takeCompactionRequest(userId)) return saveUserData(userId, user);
+        return true;
+    }
+   
+    static void flush() { worker().flush(); }
+    static void shutdown() { worker().stop(); }
+};
+
+// -------------------- WORK-STEALING THREAD POOL --------------------
+// Every worker owns a deque. It takes its own newest task first and, once that runs
+// dry, steals the oldest task from another worker, so a few heavy tasks don't leave
+// the other threads idle. Tasks submitted from inside a task stay on that worker.
+class WorkStealingPool {
+private:
+    struct Queue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> workers;
+    mutex idleMutex;
+    condition_variable wake;
+    condition_variable done;
+    size_t queued = 0;        // waiting in some deque
+    size_t unfinished = 0;    // queued or running
+    size_t nextQueue = 0;
+    bool stopping = false;
+
+    static thread_local WorkStealingPool* currentPool;
+    static thread_local size_t currentWorker;
+
+    bool take(size_t self, function<void()>& task) {
+        for (size_t k = 0; k < queues.size(); k++) {
+            Queue& queue = *queues[(self + k) % queues.size()];
+            lock_guard<mutex> lock(queue.lock);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = move(queue.tasks.back());    // own work: newest first, still warm in cache
+                queue.tasks.pop_back();
+            } else {
+                task = move(queue.tasks.front());   // stolen work: oldest first
+                queue.tasks.pop_front();
+            }
+            lock_guard<mutex> idle(idleMutex);
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t self) {
+        currentPool = this;
+        currentWorker = self;
+        while (true) {
+            function<void()> task;
+            if (take(self, task)) {
+                task();
+                lock_guard<mutex> lock(idleMutex);
+                if (--unfinished == 0) done.notify_all();
+                continue;
+            }
+            unique_lock<mutex> lock(idleMutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+        }
+    }
+
+public:
+    explicit WorkStealingPool(size_t threads = thread::hardware_concurrency()) {
+        threads = max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; i++) queues.push_back(make_unique<Queue>());
+        for (size_t i = 0; i < threads; i++) workers.emplace_back(&WorkStealingPool::run, this, i);
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lock(idleMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    size_t threadCount() const { return workers.size(); }
+
+    void submit(function<void()> task) {
+        size_t target;
+        {
+            lock_guard<mutex> lock(idleMutex);
+            target = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+            queued++;
+            unfinished++;
+        }
+        {
+            lock_guard<mutex> lock(queues[target]->lock);
+            queues[target]->tasks.push_back(move(task));
+        }
+        wake.notify_one();
+    }
+
+    // Blocks until every submitted task (including ones they submitted) has finished
+    void wait() {
+        unique_lock<mutex> lock(idleMutex);
+        done.wait(lock, [this] { return unfinished == 0; });
+    }
+};
+
+thread_local WorkStealingPool* WorkStealingPool::currentPool = nullptr;
+thread_local size_t WorkStealingPool::currentWorker = 0;
+
+// -------------------- CROSS-USER RANKINGS --------------------
+// Scans every user directory in parallel (one task per shard) and ranks the given user
+// by total study time and by time in each of their subjects.
+class RankingEngine {
+public:
+    struct Standing {
+        int rank = 0;              // 1 = most study time
+        int outOf = 0;
+        double percentile = 0;     // share of students with less time, 0-100
+        int64_t seconds = 0;
+    };
+
+    struct Result {
+        Standing overall;
+        map<string, Standing> bySubject;
+        map<string, QuantileSketch> cohortFocus;   // all students' session lengths, for the user's subjects
+        int64_t medianSeconds = 0;
+        size_t usersScanned = 0;
+        double elapsedSeconds = 0;
+    };
+
+private:
+    struct Aggregate {
+        int userId = 0;
+        int64_t total = 0;
+        vector<pair<string, int64_t>> subjects;
+        vector<QuantileSketch> focus;   // parallel to subjects
+    };
+
+    // Everything one task found, merged into the shared tallies in one step
+    struct Partial {
+        vector<pair<int, int64_t>> totals;   // (user id, seconds)
+        unordered_map<string, vector<int64_t>> subjectTotals;
+        unordered_map<string, QuantileSketch> cohortFocus;
+        bool foundUser = false;
+        Aggregate user;
+    };
+
+    static WorkStealingPool& pool() {
+        static WorkStealingPool instance;
+        return instance;
+    }
+
+    // Reads totals straight from the mapped snapshot. Users with pending journal records
+    // (still logged in elsewhere, or a crash before compaction) go through a full load.
+    static bool readAggregate(const string& dir, int userId, Aggregate& out) {
+        out.userId = userId;
+        error_code ec;
+        if (!Journal::hasRecords(dir + "/journal.log")) {
+            MappedFile file;
+            SessionStore::Columns cols;
+            if (SessionStore::mapFile(dir + "/sessions.dat", file, cols) ||
+                SessionStore::mapFile(Checkpoint::previous(dir + "/sessions.dat"), file, cols)) {
+                out.total = ColumnKernels::sum(cols.duration, cols.rows());
+                auto finished = [&cols](uint32_t i) { return cols.end[i] > cols.start[i]; };
+                if (cols.subjectCode) {
+                    vector<int64_t> byCode(cols.header->subjectCount);
+                    out.focus.resize(byCode.size());
+                    for (uint32_t i = 0; i < cols.rows(); i++) {
+                        byCode[cols.subjectCode[i]] += cols.duration[i];
+                        if (finished(i)) out.focus[cols.subjectCode[i]].add(cols.duration[i]);
+                    }
+                    for (uint32_t code = 0; code < byCode.size(); code++)
+                        out.subjects.emplace_back(cols.str(cols.subjectTable[code]), byCode[code]);
+                } else {
+                    map<string_view, pair<int64_t, QuantileSketch>> bySubject;
+                    for (uint32_t i = 0; i < cols.rows(); i++) {
+                        auto& entry = bySubject[cols.subjectName(i)];
+                        entry.first += cols.duration[i];
+                        if (finished(i)) entry.second.add(cols.duration[i]);
+                    }
+                    for (auto& entry : bySubject) {
+                        out.subjects.emplace_back(string(entry.first), entry.second.first);
+                        out.focus.push_back(move(entry.second.second));
+                    }
+                }
+                return true;
+            }
+            if (!fs::exists(dir + "/sessions.dat", ec)) return false;
+        }
+        User user(userId, "", User::Credentials(), "");
+        user.loadUserData(dir + "/sessions.dat", dir + "/todo.dat");
+        Journal::replayReadOnly(dir + "/journal.log", user);
+        out.total = user.getTotalStudyTime();
+        user.forEachSubjectTotal([&out, &user](const string& subject, const User::SubjectTotals& totals) {
+            out.subjects.emplace_back(subject, totals.duration);
+            out.focus.push_back(user.getSketches(subject).focus);
+        });
+        return true;
+    }
+
+    static void scanDirectory(const fs::path& dir, int userId, Partial& partial) {
+        Aggregate aggregate;
+        if (!readAggregate(dir.string(), userId, aggregate)) return;
+        partial.totals.emplace_back(userId, aggregate.total);
+        for (size_t i = 0; i < aggregate.subjects.size(); i++) {
+            partial.subjectTotals[aggregate.subjects[i].first].push_back(aggregate.subjects[i].second);
+            partial.cohortFocus[aggregate.subjects[i].first].merge(aggregate.focus[i]);
+        }
+        if (aggregate.userId == partial.user.userId) {
+            partial.foundUser = true;
+            partial.user = move(aggregate);
+        }
+    }
+
+    static int userIdOf(const fs::path& dir) {
+        string name = dir.filename().string();
+        if (name.compare(0, 5, "user_") != 0) return 0;
+        return TextScan::toNumber<int>(string_view(name).substr(5));
+    }
+
+    // `values` sorted ascending
+    static Standing standingOf(const vector<int64_t>& values, int64_t mine) {
+        Standing standing;
+        standing.seconds = mine;
+        standing.outOf = values.size();
+        size_t below = lower_bound(values.begin(), values.end(), mine) - values.begin();
+        size_t atOrBelow = upper_bound(values.begin(), values.end(), mine) - values.begin();
+        standing.rank = static_cast<int>(values.size() - atOrBelow) + 1;
+        standing.percentile = values.empty() ? 0 : 100.0 * below / values.size();
+        return standing;
+    }
+
+    // Reads every user directory in parallel; `userId`'s own aggregate is kept whole
+    static Partial scan(const string& dataDir, int userId) {
+        mutex mergeMutex;
+        Partial merged;
+        merged.user.userId = userId;
+
+        auto scanShard = [&](fs::path shard, bool legacy) {
+            Partial partial;
+            partial.user.userId = userId;
+            error_code ec;
+            if (legacy) {
+                scanDirectory(shard, userIdOf(shard), partial);
+            } else {
+                for (const auto& entry : fs::directory_iterator(shard, ec)) {
+                    int id = userIdOf(entry.path());
+                    if (id > 0) scanDirectory(entry.path(), id, partial);
+                }
+            }
+            lock_guard<mutex> lock(mergeMutex);
+            merged.totals.insert(merged.totals.end(), partial.totals.begin(), partial.totals.end());
+            for (auto& subject : partial.subjectTotals) {
+                vector<int64_t>& into = merged.subjectTotals[subject.first];
+                into.insert(into.end(), subject.second.begin(), subject.second.end());
+            }
+            for (const auto& subject : partial.cohortFocus) merged.cohortFocus[subject.first].merge(subject.second);
+            if (partial.foundUser) {
+                merged.foundUser = true;
+                merged.user = move(partial.user);
+            }
+        };
+
+        error_code ec;
+        for (const auto& entry : fs::directory_iterator(dataDir, ec)) {
+            if (!entry.is_directory(ec)) continue;
+            fs::path path = entry.path();
+            bool legacy = userIdOf(path) > 0;   // data/user_<id> from before sharding
+            pool().submit([&scanShard, path, legacy] { scanShard(path, legacy); });
+        }
+        pool().wait();
+        return merged;
+    }
+
+public:
+    static Result compute(const string& dataDir, int userId) {
+        auto started = chrono::steady_clock::now();
+        Partial merged = scan(dataDir, userId);
+
+        Result result;
+        vector<int64_t> totals;
+        totals.reserve(merged.totals.size());
+        for (const auto& entry : merged.totals) totals.push_back(entry.second);
+        result.usersScanned = totals.size();
+        sort(totals.begin(), totals.end());
+        if (!totals.empty()) result.medianSeconds = totals[totals.size() / 2];
+        result.overall = standingOf(totals, merged.user.total);
+        for (const auto& subject : merged.user.subjects) {
+            vector<int64_t>& values = merged.subjectTotals[subject.first];
+            sort(values.begin(), values.end());
+            result.bySubject[subject.first] = standingOf(values, subject.second);
+            result.cohortFocus[subject.first] = merged.cohortFocus[subject.first];
+        }
+        result.elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return result;
+    }
+
+    // Total study time of every user on disk, used to seed the leaderboard
+    static vector<pair<int, int64_t>> collectTotals(const string& dataDir) {
+        return scan(dataDir, 0).totals;
+    }
+};
+
+// -------------------- LEADERBOARD (order-statistic skip list) --------------------
+// Users ordered by total study time (ties by id). Every forward link records how many
+// users it skips, so rank, k-th user, top K and "around me" all cost O(log n).
+// Persisted as a sorted snapshot (leaderboard.db) plus an append-only log of updates
+// (leaderboard.log) that is folded into the snapshot once it grows.
+class Leaderboard {
+public:
+    struct Entry {
+        int rank = 0;
+        int userId = 0;
+        int64_t total = 0;
+        string name;
+    };
+
+private:
+    static constexpr char MAGIC[4] = {'S', 'S', 'L', 'B'};
+    static constexpr int MAX_LEVEL = 24;
+    static constexpr size_t COMPACT_RECORDS = 4096;
+
+    struct Node {
+        int userId;
+        int64_t total;
+        string name;
+        vector<Node*> next;
+        vector<size_t> span;   // users passed when following next[level]
+
+        Node(int userId, int64_t total, const string& name, int levels)
+            : userId(userId), total(total), name(name), next(levels, nullptr), span(levels, 0) {}
+    };
+
+    Node head;
+    int levels = 1;
+    size_t count = 0;
+    unordered_map<int, Node*> byUser;
+    mt19937 rng{0x5eed};
+    string snapshotPath;
+    string logPath;
+    int logFd = -1;
+    size_t logRecords = 0;
+
+    // More time first; equal totals by ascending id
+    static bool before(int64_t totalA, int idA, int64_t totalB, int idB) {
+        return totalA > totalB || (totalA == totalB && idA < idB);
+    }
+
+    int randomLevel() {
+        int level = 1;
+        while (level < MAX_LEVEL && (rng() & 3) == 0) level++;   // p = 1/4
+        return level;
+    }
+
+    void link(int userId, int64_t total, const string& name) {
+        Node* update[MAX_LEVEL];
+        size_t rank[MAX_LEVEL];
+        Node* x = &head;
+        for (int i = levels - 1; i >= 0; i--) {
+            rank[i] = i == levels - 1 ? 0 : rank[i + 1];
+            while (x->next[i] && before(x->next[i]->total, x->next[i]->userId, total, userId)) {
+                rank[i] += x->span[i];
+                x = x->next[i];
+            }
+            update[i] = x;
+        }
+        int level = randomLevel();
+        for (int i = levels; i < level; i++) {
+            rank[i] = 0;
+            update[i] = &head;
+            head.span[i] = count;
+        }
+        levels = max(levels, level);
+
+        Node* node = new Node(userId, total, name, level);
+        for (int i = 0; i < level; i++) {
+            node->next[i] = update[i]->next[i];
+            update[i]->next[i] = node;
+            node->span[i] = update[i]->span[i] - (rank[0] - rank[i]);
+            update[i]->span[i] = rank[0] - rank[i] + 1;
+        }
+        for (int i = level; i < levels; i++) update[i]->span[i]++;
+        byUser[userId] = node;
+        count++;
+    }
+
+    void unlink(Node* node) {
+        Node* x = &head;
+        for (int i = levels - 1; i >= 0; i--) {
+            while (x->next[i] && before(x->next[i]->total, x->next[i]->userId, node->total, node->userId))
+                x = x->next[i];
+            if (x->next[i] == node) {
+                x->span[i] += node->span[i] - 1;
+                x->next[i] = node->next[i];
+            } else {
+                x->span[i]--;
+            }
+        }
+        while (levels > 1 && !head.next[levels - 1]) levels--;
+        byUser.erase(node->userId);
+        delete node;
+        count--;
+    }
+
+    Node* nodeAt(size_t rank) const {
+        const Node* x = &head;
+        size_t traversed = 0;
+        for (int i = levels - 1; i >= 0; i--) {
+            while (x->next[i] && traversed + x->span[i] <= rank) {
+                traversed += x->span[i];
+                x = x->next[i];
+            }
+            if (traversed == rank) return const_cast<Node*>(x);
+        }
+        return nullptr;
+    }
+
+    void clear() {
+        for (Node* x = head.next[0]; x; ) {
+            Node* following = x->next[0];
+            delete x;
+            x = following;
+        }
+        fill(head.next.begin(), head.next.end(), nullptr);
+        fill(head.span.begin(), head.span.end(), 0);
+        levels = 1;
+        count = 0;
+        byUser.clear();
+    }
+
+    static void encodeEntry(ByteWriter& out, int userId, int64_t total, const string& name) {
+        ByteWriter body;
+        body.i32(userId).i64(total).str(name);
+        out.i32(static_cast<int32_t>(body.bytes().size()))
+           .i32(static_cast<int32_t>(Checksum::crc32c(body.bytes().data(), body.bytes().size())))
+           .raw(body.bytes().data(), body.bytes().size());
+    }
+
+    // Reads framed entries until the data ends or one fails its checksum; returns the
+    // number of bytes that were intact
+    template <typename Visitor>
+    static size_t decodeEntries(const char* data, size_t size, Visitor visit) {
+        ByteReader in(data, size);
+        size_t good = 0;
+        while (true) {
+            int32_t length = in.i32();
+            uint32_t crc = static_cast<uint32_t>(in.i32());
+            const char* body = in.skip(length);
+            if (!in.ok() || length < 1 || !body || Checksum::crc32c(body, length) != crc) break;
+            ByteReader entry(body, length);
+            int userId = entry.i32();
+            int64_t total = entry.i64();
+            string name = entry.str();
+            if (!entry.ok()) break;
+            visit(userId, total, name);
+            good = body + length - data;
+        }
+        return good;
+    }
+
+    // Snapshot entries are already in rank order, so they are appended at the tail
+    // in O(1) each instead of being searched for
+    bool loadSnapshot(const string& filename) {
+        string data;
+        if (!TextScan::readFile(filename, data)) return false;
+        if (data.size() < sizeof(MAGIC) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+
+        Node* tail[MAX_LEVEL];
+        size_t tailRank[MAX_LEVEL];
+        fill(tail, tail + MAX_LEVEL, &head);
+        fill(tailRank, tailRank + MAX_LEVEL, 0);
+        bool sorted = true;
+        size_t good = decodeEntries(data.data() + sizeof(MAGIC), data.size() - sizeof(MAGIC),
+            [&](int userId, int64_t total, const string& name) {
+                if (!sorted || byUser.count(userId)) { sorted = false; return; }
+                Node* last = count ? tail[0] : nullptr;
+                if (last && !before(last->total, last->userId, total, userId)) { sorted = false; return; }
+                int level = randomLevel();
+                levels = max(levels, level);
+                Node* node = new Node(userId, total, name, level);
+                for (int i = 0; i < level; i++) {
+                    tail[i]->next[i] = node;
+                    tail[i]->span[i] = count + 1 - tailRank[i];
+                    tail[i] = node;
+                    tailRank[i] = count + 1;
+                }
+                byUser[userId] = node;
+                count++;
+            });
+        if (!sorted || good != data.size() - sizeof(MAGIC)) {
+            cerr << filename << " is damaged." << endl;
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    void replayLog() {
+        string data;
+        if (!TextScan::readFile(logPath, data)) return;
+        size_t good = decodeEntries(data.data(), data.size(), [this](int userId, int64_t total, const string& name) {
+            apply(userId, total, name);
+            logRecords++;
+        });
+        if (good < data.size()) {
+            error_code ec;
+            fs::resize_file(logPath, good, ec);   // torn append from a crash
+        }
+    }
+
+    void apply(int userId, int64_t total, const string& name) {
+        auto it = byUser.find(userId);
+        if (it != byUser.end()) unlink(it->second);
+        link(userId, total, name);
+    }
+
+    bool openLog() {
+        if (logFd >= 0) ::close(logFd);
+        logFd = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        return logFd >= 0;
+    }
+
+public:
+    Leaderboard() : head(0, 0, "", MAX_LEVEL) {}
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+    ~Leaderboard() {
+        clear();
+        if (logFd >= 0) ::close(logFd);
+    }
+
+    // False when there is nothing on disk yet (or it is unreadable) and the caller should seed()
+    bool open(const string& snapshotFile, const string& logFile) {
+        snapshotPath = snapshotFile;
+        logPath = logFile;
+        clear();
+        logRecords = 0;
+        bool loaded = loadSnapshot(snapshotPath) || loadSnapshot(Checkpoint::previous(snapshotPath));
+        if (!loaded) clear();
+        if (loaded) replayLog();
+        return openLog() && loaded;
+    }
+
+    // Replaces the contents wholesale (first start, or a damaged snapshot) and persists them
+    bool seed(const vector<Entry>& entries) {
+        clear();
+        for (const auto& entry : entries) apply(entry.userId, entry.total, entry.name);
+        return compact();
+    }
+
+    // Moves a user to their new total; a no-op when nothing changed
+    bool update(int userId, int64_t total, const string& name) {
+        auto it = byUser.find(userId);
+        if (it != byUser.end() && it->second->total == total && it->second->name == name) return true;
+        apply(userId, total, name);
+
+        // Synced like the journal, so a crash can't drop rank updates the snapshot lacks
+        ByteWriter record;
+        encodeEntry(record, userId, total, name);
+        if (logFd < 0 || write(logFd, record.bytes().data(), record.bytes().size()) !=
+                             static_cast<ssize_t>(record.bytes().size()) || fsync(logFd) != 0)
+            return compact();
+        return ++logRecords < COMPACT_RECORDS || compact();
+    }
+
+    // Writes every entry in rank order as the new snapshot and empties the log
+    bool compact() {
+        ByteWriter out;
+        out.raw(MAGIC, sizeof(MAGIC));
+        for (Node* x = head.next[0]; x; x = x->next[0]) encodeEntry(out, x->userId, x->total, x->name);
+        if (!Checkpoint::writeFile(snapshotPath, out.bytes().data(), out.bytes().size())) return false;
+        if (truncate(logPath.c_str(), 0) != 0 && errno != ENOENT) return false;
+        logRecords = 0;
+        return openLog();
+    }
+
+    size_t size() const { return count; }
+
+    // 1-based rank, or 0 for a user who is not on the board
+    size_t rankOf(int userId) const {
+        auto it = byUser.find(userId);
+        if (it == byUser.end()) return 0;
+        const Node* target = it->second;
+        const Node* x = &head;
+        size_t rank = 0;
+        for (int i = levels - 1; i >= 0; i--) {
+            while (x->next[i] && !before(target->total, target->userId, x->next[i]->total, x->next[i]->userId)) {
+                rank += x->span[i];
+                x = x->next[i];
+            }
+            if (x == target) return rank;
+        }
+        return 0;
+    }
+
+    // Entries ranked [first, first + n)
+    vector<Entry> range(size_t first, size_t n) const {
+        vector<Entry> result;
+        if (first < 1) first = 1;
+        for (Node* x = nodeAt(first); x && result.size() < n; x = x->next[0])
+            result.push_back({static_cast<int>(first + result.size()), x->userId, x->total, x->name});
+        return result;
+    }
+
+    vector<Entry> top(size_t k) const { return range(1, k); }
+
+    // Up to `radius` users either side of userId, userId included
+    vector<Entry> around(int userId, size_t radius) const {
+        size_t rank = rankOf(userId);
+        if (rank == 0) return {};
+        size_t first = rank > radius ? rank - radius : 1;
+        return range(first, rank - first + radius + 1);
+    }
+};
+
+// -------------------- REMINDERS (hierarchical timer wheel) --------------------
+// Six levels of 64 one-second slots. A timer sits on the level of the highest
+// 6-bit digit where its expiry differs from the current tick and is moved down at
+// most once per level, so each reminder costs O(1) to schedule, cancel and fire.
+// Occupancy bitmaps let the wheel jump straight to the next slot with work in it.
+class TimerWheel {
+public:
+    struct Reminder {
+        int userId;
+        int itemId;
+        time_t due;
+        string text;
+    };
+
+private:
+    static constexpr int LEVELS = 6;
+    static constexpr int BITS = 6;
+    static constexpr int SLOTS = 1 << BITS;
+    static constexpr int32_t NIL = -1;
+
+    struct Node {
+        Reminder reminder;
+        int64_t expire = 0;
+        int32_t prev = NIL;
+        int32_t next = NIL;
+        int level = 0;
+        int slot = 0;
+    };
+
+    vector<Node> nodes;
+    vector<int32_t> freeNodes;
+    int32_t heads[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS] = {};
+    unordered_map<uint64_t, int32_t> nodeOf;   // (user, item) -> node
+    int64_t now;
+
+    static uint64_t key(int userId, int itemId) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(userId)) << 32) | static_cast<uint32_t>(itemId);
+    }
+
+    // Caller guarantees expire > now
+    void link(int32_t n) {
+        Node& node = nodes[n];
+        uint64_t differing = static_cast<uint64_t>(node.expire ^ now);
+        node.level = (63 - __builtin_clzll(differing)) / BITS;
+        node.slot = (node.expire >> (node.level * BITS)) & (SLOTS - 1);
+        node.prev = NIL;
+        node.next = heads[node.level][node.slot];
+        if (node.next != NIL) nodes[node.next].prev = n;
+        heads[node.level][node.slot] = n;
+        occupied[node.level] |= 1ull << node.slot;
+    }
 
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-        if (!renderer) {
-            cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << endl;
-            SDL_DestroyWindow(window);
-            TTF_Quit();
-            SDL_Quit();
-            return false;
+    void unlink(int32_t n) {
+        Node& node = nodes[n];
+        if (node.prev != NIL) nodes[node.prev].next = node.next;
+        else heads[node.level][node.slot] = node.next;
+        if (node.next != NIL) nodes[node.next].prev = node.prev;
+        if (heads[node.level][node.slot] == NIL) occupied[node.level] &= ~(1ull << node.slot);
+    }
+
+    void release(int32_t n) {
+        nodeOf.erase(key(nodes[n].reminder.userId, nodes[n].reminder.itemId));
+        nodes[n].reminder.text.clear();
+        freeNodes.push_back(n);
+    }
+
+public:
+    explicit TimerWheel(int64_t start) : now(max<int64_t>(start, 0)) {
+        for (auto& level : heads) fill(level, level + SLOTS, NIL);
+    }
+
+    int64_t currentTick() const { return now; }
+    size_t size() const { return nodeOf.size(); }
+
+    // Replaces any earlier timer for the same item. Returns false, storing nothing,
+    // when `when` is not in the future; the caller delivers those right away.
+    bool schedule(const Reminder& reminder, int64_t when) {
+        cancel(reminder.userId, reminder.itemId);
+        if (when <= now) return false;
+        when = min(when, now | ((int64_t(1) << (LEVELS * BITS)) - 1));   // ~2000 years out
+        int32_t n;
+        if (freeNodes.empty()) {
+            n = nodes.size();
+            nodes.emplace_back();
+        } else {
+            n = freeNodes.back();
+            freeNodes.pop_back();
         }
-        //to  Load font
-        font = TTF_OpenFont("/System/Library/Fonts/Supplemental/Arial.ttf", 16);
-        if (!font) {
-            cerr << "Failed to load font! TTF_Error: " << TTF_GetError() << endl;
-                  }
-       
-        sdlInitialized = true;
+        nodes[n].reminder = reminder;
+        nodes[n].expire = when;
+        link(n);
+        nodeOf[key(reminder.userId, reminder.itemId)] = n;
         return true;
     }
-    // Render the pie chart using SDL
-    void renderSDL() {
-        if (!sdlInitialized && !initSDL()) {
-            cerr << "Failed to initialize SDL. Falling back to text-based rendering." << endl;
-            renderTextBased();
-            return;
+
+    bool cancel(int userId, int itemId) {
+        auto it = nodeOf.find(key(userId, itemId));
+        if (it == nodeOf.end()) return false;
+        unlink(it->second);
+        release(it->second);
+        return true;
+    }
+
+    // Walks every timer; only used when a user logs out
+    void cancelUser(int userId) {
+        vector<int32_t> doomed;
+        for (const auto& entry : nodeOf)
+            if (nodes[entry.second].reminder.userId == userId) doomed.push_back(entry.second);
+        for (int32_t n : doomed) {
+            unlink(n);
+            release(n);
         }
-        // to Create pie chart
-        SDLPieChart pieChart(renderer, font, 400, 300, 150);
-        pieChart.setTitle(title);
-        for (const auto& pair : data) {
-            pieChart.addDataPoint(pair.first, pair.second);
+    }
+
+    // Tick at which the next occupied slot comes up, or -1 when the wheel is empty.
+    // Every timer on a level is ahead of that level's current slot, and anything on
+    // a higher level comes after the current lower-level block, so the lowest
+    // occupied level decides.
+    int64_t nextEvent() const {
+        for (int level = 0; level < LEVELS; level++) {
+            int shift = level * BITS;
+            int current = (now >> shift) & (SLOTS - 1);
+            uint64_t ahead = current == SLOTS - 1 ? 0 : occupied[level] & (~0ull << (current + 1));
+            if (ahead) {
+                int64_t block = (now >> (shift + BITS)) << (shift + BITS);
+                return block | (static_cast<int64_t>(__builtin_ctzll(ahead)) << shift);
+            }
         }
-     
-        // Main loop flag
-        bool quit = false;
-        // Event handler
-        SDL_Event e;
-        while (!quit) {
-            // Handle events
-            while (SDL_PollEvent(&e) != 0) {
-                if (e.type == SDL_QUIT) {
-                    quit = true;
-                }
-                else if (e.type == SDL_KEYDOWN) {
-                    if (e.key.keysym.sym == SDLK_ESCAPE || e.key.keysym.sym == SDLK_RETURN) {
-                        quit = true;
+        return -1;
+    }
+
+    // Moves the wheel to `tick`, appending every reminder that came due to `fired`
+    void advance(int64_t tick, vector<Reminder>& fired) {
+        while (true) {
+            int64_t next = nextEvent();
+            if (next < 0 || next > tick) {
+                now = max(now, tick);
+                return;
+            }
+            now = next;
+            // Slots whose turn starts now are redistributed, highest level first
+            for (int level = LEVELS - 1; level >= 1; level--) {
+                if (now & ((int64_t(1) << (level * BITS)) - 1)) continue;
+                int slot = (now >> (level * BITS)) & (SLOTS - 1);
+                int32_t n = heads[level][slot];
+                heads[level][slot] = NIL;
+                occupied[level] &= ~(1ull << slot);
+                while (n != NIL) {
+                    int32_t following = nodes[n].next;
+                    if (nodes[n].expire <= now) {
+                        fired.push_back(move(nodes[n].reminder));
+                        release(n);
+                    } else {
+                        link(n);
                     }
+                    n = following;
                 }
             }
-           
-            // Clear screen
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-            SDL_RenderClear(renderer);
-           
-            // Render pie chart
-            pieChart.render();
-           
-            // Render instructions
-            SDL_Color textColor = {255, 255, 255, 255};
-            renderText(renderer, font, "Press ESC or ENTER to return", 400, 550, textColor, true);
-           
-            // Update screen
-            SDL_RenderPresent(renderer);
-           
-            // Cap to 60 FPS
-            SDL_Delay(16);
+            int slot = now & (SLOTS - 1);
+            for (int32_t n = heads[0][slot]; n != NIL; ) {
+                int32_t following = nodes[n].next;
+                fired.push_back(move(nodes[n].reminder));
+                release(n);
+                n = following;
+            }
+            heads[0][slot] = NIL;
+            occupied[0] &= ~(1ull << slot);
         }
     }
-   
-    void render() override {
-        // First generate the text-based content for saving to file
-        renderTextBased();
-       
-        // Then render the graphical version if requested
-        cout << "Would you like to view the pie chart graphically? (y/n): ";
-        string response;
-        getline(cin, response);
-       
-        if (response == "y" || response == "Y") {
-            renderSDL();
+};
+
+// One background thread drives the wheel. It sleeps until the next occupied slot
+// (or until an earlier reminder is scheduled), so an idle wheel costs no CPU no
+// matter how many reminders it holds. Fired reminders wait in a mailbox until
+// the menus pick them up for the logged-in user.
+class ReminderScheduler {
+public:
+    using Reminder = TimerWheel::Reminder;
+    static constexpr int REMIND_AHEAD = 24 * 60 * 60;   // first notice a day before the due date
+
+private:
+    mutable mutex lock;
+    condition_variable wakeup;
+    TimerWheel wheel;
+    deque<Reminder> notices;
+    int64_t sleepingUntil = numeric_limits<int64_t>::max();
+    bool stopping = false;
+    thread worker;
+
+    void run() {
+        unique_lock<mutex> guard(lock);
+        vector<Reminder> fired;
+        while (!stopping) {
+            wheel.advance(time(nullptr), fired);
+            for (auto& reminder : fired) notices.push_back(move(reminder));
+            fired.clear();
+            int64_t next = wheel.nextEvent();
+            sleepingUntil = next < 0 ? numeric_limits<int64_t>::max() : next;
+            if (next < 0) wakeup.wait(guard);
+            else wakeup.wait_until(guard, chrono::system_clock::from_time_t(next));
         }
     }
-};
 
-// ------------------ BREAK TIME FUNCTIONS ------------------------
-// Function to play background music during breaks
-void playBackgroundMusic(const char* musicFile) {
-    // Initialize SDL_mixer
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << endl;
-        return;
+    // Lock held
+    void add(int userId, const TodoItem& item) {
+        if (item.isCompleted() || item.getDueDate() == 0) {
+            wheel.cancel(userId, item.getId());
+            return;
+        }
+        Reminder reminder{userId, item.getId(), item.getDueDate(), item.getDescription()};
+        int64_t when = static_cast<int64_t>(item.getDueDate()) - REMIND_AHEAD;
+        if (!wheel.schedule(reminder, when)) notices.push_back(move(reminder));
+        else if (when < sleepingUntil) wakeup.notify_one();
     }
-   
-    // Load music file
-    backgroundMusic = Mix_LoadMUS(musicFile);
-    if (!backgroundMusic) {
-        cerr << "Failed to load background music! SDL_mixer Error: " << Mix_GetError() << endl;
-        Mix_CloseAudio();
-        return;
+
+public:
+    ReminderScheduler() : wheel(time(nullptr)) {}
+    ~ReminderScheduler() { stop(); }
+
+    ReminderScheduler(const ReminderScheduler&) = delete;
+    ReminderScheduler& operator=(const ReminderScheduler&) = delete;
+
+    void start() {
+        lock_guard<mutex> guard(lock);
+        if (worker.joinable()) return;
+        stopping = false;
+        worker = thread(&ReminderScheduler::run, this);
     }
-   
-    // Play music on loop
-    Mix_PlayMusic(backgroundMusic, -1);
-   
-    // Keep thread alive while break is active
-    while (breakActive) {
-        SDL_Delay(100);
+
+    void stop() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        if (worker.joinable()) worker.join();
     }
-   
-    // Stop and clean up when break ends
-    Mix_HaltMusic();
-    Mix_FreeMusic(backgroundMusic);
-    backgroundMusic = nullptr;
-    Mix_CloseAudio();
-}
-// Utility functions
-void clearScreen() { system("clear"); }
-void pauseExecution() {
-    cout << "\nPress Enter to continue...";
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-}
-// Function to handle break time
-void takeBreak() {
-    clearScreen();
-    cout << "===== BREAK TIME =====" << endl;
-    cout << "Your study session is paused. Enjoy your break!" << endl;
-    cout << "Playing relaxing music..." << endl;
-    cout << "\nPress Enter to end your break and resume studying..." << endl;
-   
-    // Set break as active
-    breakActive = true;
-   
-    // Start music in a separate thread
-    musicThread = thread(playBackgroundMusic, "/Users/chiragsingh/Downloads/blue\ bird\ \(Naruto\ but\ is\ it\ okay\ if\ it\'s\ lofi\ hiphop_\).mp3");
-   
-    // Wait for user to press Enter
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-   
-    // End break
-    breakActive = false;
-   
-    // Wait for music thread to finish
-    if (musicThread.joinable()) {
-        musicThread.join();
+
+    // (Re)schedules one item; completed or undated items just lose their reminder
+    void schedule(int userId, const TodoItem& item) {
+        lock_guard<mutex> guard(lock);
+        add(userId, item);
     }
-   
-    cout << "Break ended. Resuming study session..." << endl;
-    pauseExecution();
-}
 
-// --------------------------FILE MANAGEMENT --------------------
-class FileManager {
-public:
-    static bool saveUserData(int userId, User* user) {
-        if (!user) return false;
-        string userDir = "data/user_" + to_string(userId);
-        system(("mkdir -p " + userDir).c_str());
-        return user->saveUserData(userDir + "/sessions.dat", userDir + "/todo.dat");
+    // Every open item of a user who just logged in
+    void scheduleAll(int userId, const TodoList& todoList) {
+        lock_guard<mutex> guard(lock);
+        for (const auto& item : todoList.getIncompleteItems()) add(userId, item);
     }
-   
-    static bool loadUserData(int userId, User* user) {
-        if (!user) return false;
-        string userDir = "data/user_" + to_string(userId);
-        return user->loadUserData(userDir + "/sessions.dat", userDir + "/todo.dat");
+
+    void cancel(int userId, int itemId) {
+        lock_guard<mutex> guard(lock);
+        wheel.cancel(userId, itemId);
+        notices.erase(remove_if(notices.begin(), notices.end(), [&](const Reminder& reminder) {
+            return reminder.userId == userId && reminder.itemId == itemId;
+        }), notices.end());
     }
-   
-    static bool saveUserCredentials(const vector<User*>& users) {
-        ofstream file("users.dat");
-        if (!file.is_open()) return false;
-        for (const auto& user : users) {
-            if (user) file << user->getId() << "|" << user->getUsername() << "|"
-                           << user->getFullName() << "|" << endl;
-        }
-        return true;
+
+    void cancelUser(int userId) {
+        lock_guard<mutex> guard(lock);
+        wheel.cancelUser(userId);
+        notices.erase(remove_if(notices.begin(), notices.end(),
+                                [userId](const Reminder& reminder) { return reminder.userId == userId; }),
+                      notices.end());
+    }
+
+    // Reminders that fired for this user since the last call, oldest first
+    vector<Reminder> takeNotices(int userId) {
+        lock_guard<mutex> guard(lock);
+        vector<Reminder> taken;
+        auto keep = remove_if(notices.begin(), notices.end(), [&](Reminder& reminder) {
+            if (reminder.userId != userId) return false;
+            taken.push_back(move(reminder));
+            return true;
+        });
+        notices.erase(keep, notices.end());
+        return taken;
+    }
+
+    size_t pending() const {
+        lock_guard<mutex> guard(lock);
+        return wheel.size();
     }
 };
 
 // ----------------------MAIN APPLICATION-----------------------
-vector<User*> users;
-int nextUserId = 1;
+UserRegistry userRegistry;
+Leaderboard leaderboard;   // kept next to users.db
+ReminderScheduler reminders;   // open todos of logged-in users
+unordered_map<string, User*> users;   // accounts loaded in this run, by username
 FileUploader fileUploader;
 
 void uploadImageToSession(int sessionId);
 void uploadNotesToSession(int sessionId);
 void viewSessionAttachments(int sessionId);
 
+// Called wherever a user's total can change (ending a session, journal replay at login)
+void syncLeaderboard(const User* user) {
+    if (!leaderboard.update(user->getId(), user->getTotalStudyTime(), user->getUsername()))
+        cerr << "Could not save the leaderboard." << endl;
+}
+
+// Keeps one todo's reminder in step after it is added, completed or removed
+void syncReminder(const User* user, int itemId) {
+    const TodoItem* item = user->getTodoList().getItem(itemId);
+    if (item) reminders.schedule(user->getId(), *item);
+    else reminders.cancel(user->getId(), itemId);
+}
+
+// Shown at the top of each menu; the scheduler thread only queues them
+void showReminders() {
+    time_t now = time(nullptr);
+    for (const auto& reminder : reminders.takeNotices(currentUser->getId())) {
+        bool overdue = reminder.due + ReminderScheduler::REMIND_AHEAD <= now;
+        cout << "Reminder: \"" << reminder.text << "\" " << (overdue ? "was due " : "is due ")
+             << Utils::formatDate(reminder.due) << endl;
+    }
+}
+
+// First run (or a damaged leaderboard.db): rebuild it once from the registry and data/
+void seedLeaderboard() {
+    unordered_map<int, int64_t> totals;
+    for (const auto& entry : RankingEngine::collectTotals("data")) totals[entry.first] = entry.second;
+    vector<Leaderboard::Entry> entries;
+    userRegistry.forEach([&](const UserRegistry::Record& record) {
+        Leaderboard::Entry entry;
+        entry.userId = record.id;
+        entry.total = totals.count(record.id) ? totals[record.id] : 0;
+        entry.name = record.username;
+        entries.push_back(entry);
+    });
+    if (!leaderboard.seed(entries)) cerr << "Could not save the leaderboard." << endl;
+}
+
 string getStringInput(const string& prompt) {
     cout << prompt;
     string input;
@@ -996,6 +5327,7 @@ int getIntInput(const string& prompt) {
 
 time_t getDateInput(const string& prompt) {
     string dateStr = getStringInput(prompt);
+    if (dateStr.empty()) return 0;   // "leave blank" means no date
     time_t date = Utils::parseDateTime(dateStr);
     if (date == 0) {
         cout << "Invalid date format. Using current time instead." << endl;
@@ -1023,6 +5355,7 @@ void markTodoItemComplete();
 void removeTodoItem();
 void generateReport();
 void viewRankings();
+void searchNotes();
 
 // Core functionality implementations
 void registerUser() {
@@ -1032,18 +5365,27 @@ void registerUser() {
     string password = getPasswordInput();
     string fullName = getStringInput("Enter full name: ");
    
-    for (const auto& user : users) {
-        if (user->getUsername() == username) {
-            cout << "Username already exists." << endl;
-            pauseExecution();
-            return;
-        }
+    if (userRegistry.contains(username)) {
+        cout << "Username already exists." << endl;
+        pauseExecution();
+        return;
     }
    
-    User* newUser = new User(nextUserId++, username, password, fullName);
-    users.push_back(newUser);
-    FileManager::saveUserCredentials(users);
+    User* newUser = new User(userRegistry.nextUserId(), username, password, fullName);
+    UserRegistry::Record record;
+    record.id = newUser->getId();
+    record.username = username;
+    record.fullName = fullName;
+    record.credentials = newUser->getCredentials();
+    if (!userRegistry.insert(record)) {
+        cout << "Could not save the new account." << endl;
+        delete newUser;
+        pauseExecution();
+        return;
+    }
+    users[username] = newUser;
     FileManager::saveUserData(newUser->getId(), newUser);
+    syncLeaderboard(newUser);
    
     cout << "Registration successful." << endl;
     pauseExecution();
@@ -1055,25 +5397,29 @@ bool loginUser() {
     string username = getStringInput("Enter username: ");
     string password = getPasswordInput();
    
-    for (auto& user : users) {
-        if (user->getUsername() == username) {
-            if (user->verifyPassword(password)) {
-                currentUser = user;
-                FileManager::loadUserData(user->getId(), user);
-                cout << "Login successful. Welcome, " << user->getFullName() << "!" << endl;
-                pauseExecution();
-                return true;
-            } else {
-                cout << "Incorrect password." << endl;
-                pauseExecution();
-                return false;
-            }
-        }
+    UserRegistry::Record record;
+    if (!userRegistry.find(username, record)) {
+        cout << "Username not found." << endl;
+        pauseExecution();
+        return false;
     }
    
-    cout << "Username not found." << endl;
-    pauseExecution();
-    return false;
+    User*& user = users[username];
+    if (!user) user = new User(record.id, record.username, record.credentials, record.fullName);
+   
+    if (user->verifyPassword(password)) {
+        currentUser = user;
+        FileManager::loadUserData(user->getId(), user);
+        syncLeaderboard(user);
+        reminders.scheduleAll(user->getId(), user->getTodoList());
+        cout << "Login successful. Welcome, " << user->getFullName() << "!" << endl;
+        pauseExecution();
+        return true;
+    } else {
+        cout << "Incorrect password." << endl;
+        pauseExecution();
+        return false;
+    }
 }
 
 // Modified startStudySession function with break time feature
@@ -1083,62 +5429,79 @@ void startStudySession() {
     string subject = getStringInput("Enter subject: ");
     string notes = getStringInput("Enter notes (optional): ");
    
-    time_t now = time(nullptr);
+    SessionTimer timer;
+    timer.start();
+    time_t now = timer.startTime();
     int sessionId = currentUser->startSession(subject, now, notes);
    
     cout << "Study session #" << sessionId << " started at "
          << Utils::formatDateTime(now) << endl;
    
-    FileManager::saveUserData(currentUser->getId(), currentUser);
+    FileManager::logMutation(currentUser->getId(), currentUser,
+                             Journal::sessionStarted(*currentUser->getSession(sessionId)));
    
-    bool sessionActive = true;
-    time_t breakStartTime = 0;
-    time_t totalBreakTime = 0;
+    // Elapsed and break counters, redrawn in place by the ticker while waiting for input
+    auto drawCounters = [&timer](TextBuffer& out) {
+        out << "Elapsed time: ";
+        out.clock(chrono::duration_cast<chrono::seconds>(timer.studied()).count());
+        out << " | Total break time: ";
+        out.clock(chrono::duration_cast<chrono::seconds>(timer.onBreak()).count());
+        return timer.untilNextSecond();
+    };
    
+    bool sessionActive = true;
+    TextBuffer screen;
     while (sessionActive) {
         clearScreen();
         cout << "===== ACTIVE STUDY SESSION =====" << endl;
         cout << "Session #" << sessionId << " - " << subject << endl;
         cout << "Started at: " << Utils::formatDateTime(now) << endl;
-        cout << "Current time: " << Utils::formatDateTime(time(nullptr)) << endl;
-        cout << "Elapsed time: " << Utils::formatDuration(difftime(time(nullptr), now) - totalBreakTime) << endl;
-       
-        if (totalBreakTime > 0) {
-            cout << "Total break time: " << Utils::formatDuration(totalBreakTime) << endl;
-        }
-       
-        cout << "\nOptions:" << endl;
-        cout << "0 - Continue studying (return to this screen)" << endl;
-        cout << "1 - Take a break (pauses study timer)" << endl;
-        cout << "2 - End study session" << endl;
+        showReminders();
        
-        int choice = getIntInput("\nEnter your choice: ");
+        screen.clear();
+        drawCounters(screen);
+        screen << "\n\nOptions:\n";
+        screen << "0 - Continue studying (return to this screen)\n";
+        screen << "1 - Take a break (pauses study timer)\n";
+        screen << "2 - End study session\n";
+        screen << "\nEnter your choice: ";
+        screen.writeTo(cout);
+        statusTicker.show(static_cast<int>(count(screen.str().begin(), screen.str().end(), '\n')), drawCounters);
+        int choice = getIntInput("");
+        statusTicker.hide();
        
         switch (choice) {
             case 0:
                 break;
                 //resets the screen
             case 1:
-                breakStartTime = time(nullptr);
-                takeBreak();
-                totalBreakTime += difftime(time(nullptr), breakStartTime);
+                takeBreak(timer);
                 break;
-            case 2:
+            case 2: {
                 sessionActive = false;
-                time_t endTime = time(nullptr);
+                timer.stop();
+                time_t endTime = timer.stopTime();
+                int totalBreakTime = timer.breakSeconds();
+                vector<int64_t> timeline = timer.timeline();
                 // Adjust end time to exclude break time
                 if (currentUser->endSession(sessionId, endTime, totalBreakTime)) {
+                    currentUser->setTimeline(sessionId, timeline);
+                    syncLeaderboard(currentUser);
                     cout << "Study session #" << sessionId << " ended at " << Utils::formatDateTime(endTime) << endl;
-                    StudySession* session = currentUser->getSession(sessionId);
+                    optional<SessionView> session = currentUser->getSession(sessionId);
                     if (session) {
                         cout << "Duration: " << Utils::formatDuration(session->getDuration()) << endl;
                         if (totalBreakTime > 0) {
                             cout << "Break time: " << Utils::formatDuration(totalBreakTime) << endl;
                         }
                     }
-                    FileManager::saveUserData(currentUser->getId(), currentUser);
+                    vector<char> records = Journal::sessionEnded(sessionId, endTime, totalBreakTime);
+                    vector<char> timed = Journal::sessionTimed(sessionId, timeline);
+                    records.insert(records.end(), timed.begin(), timed.end());
+                    FileManager::logMutation(currentUser->getId(), currentUser, records);
                 }
                 break;
+            }
         }
     }
 }
@@ -1147,27 +5510,23 @@ void endStudySession() {
     clearScreen();
     cout << "===== END STUDY SESSION =====" << endl;
    
-    vector<StudySession> sessions = currentUser->getAllSessions();
-    if (sessions.empty()) {
+    if (currentUser->getSessionCount() == 0) {
         cout << "No study sessions found." << endl;
         pauseExecution();
         return;
     }
    
     int sessionId = getIntInput("Enter session ID to end (0 for latest): ");
-    if (sessionId == 0) {
-        int latestId = 0;
-        for (const auto& session : sessions)
-            if (session.getId() > latestId) latestId = session.getId();
-        sessionId = latestId;
-    }
+    if (sessionId == 0) sessionId = currentUser->getLatestSessionId();
    
+    optional<SessionView> running = currentUser->getSession(sessionId);
     time_t now = time(nullptr);
-    if (currentUser->endSession(sessionId, now)) {
+    if (running && running->getEndTime() <= running->getStartTime() && currentUser->endSession(sessionId, now)) {
+        syncLeaderboard(currentUser);
         cout << "Study session #" << sessionId << " ended at " << Utils::formatDateTime(now) << endl;
-        StudySession* session = currentUser->getSession(sessionId);
+        optional<SessionView> session = currentUser->getSession(sessionId);
         if (session) cout << "Duration: " << Utils::formatDuration(session->getDuration()) << endl;
-        FileManager::saveUserData(currentUser->getId(), currentUser);
+        FileManager::logMutation(currentUser->getId(), currentUser, Journal::sessionEnded(sessionId, now, 0));
     } else {
         cout << "Session not found or already ended." << endl;
     }
@@ -1179,19 +5538,37 @@ void viewStudySessions() {
     clearScreen();
     cout << "------------------ STUDY SESSIONS----------------"<< endl;
    
-    vector<StudySession> sessions = currentUser->getAllSessions();
-    if (sessions.empty()) {
+    if (currentUser->getSessionCount() == 0) {
         cout << "No study sessions found." << endl;
         pauseExecution();
         return;
     }
    
-    sort(sessions.begin(), sessions.end(),
-             [](const StudySession& a, const StudySession& b) {
-                 return a.getStartTime() > b.getStartTime();
-             });
+    const size_t PAGE_SIZE = 20;
+    SessionQuery query;
+    string subject = getStringInput("Filter by subject (leave empty for all): ");
+    if (!subject.empty()) query.subject = subject;
+    query.limit = PAGE_SIZE + 1;   // one extra row tells whether another page exists
    
-    for (const auto& session : sessions) cout << session.toString() << endl;
+    TextBuffer out;
+    while (true) {
+        vector<SessionView> page = currentUser->querySessions(query);
+        if (page.empty()) {
+            cout << "No study sessions found." << endl;
+            break;
+        }
+        bool more = page.size() > PAGE_SIZE;
+        if (more) page.pop_back();
+        out.clear();
+        for (const auto& session : page) {
+            session.describe(out);
+            out << '\n';
+        }
+        out.writeTo(cout);
+       
+        if (!more || getStringInput("\nShow older sessions? (y/n): ") != "y") break;
+        query.offset += PAGE_SIZE;
+    }
     pauseExecution();
 }
 
@@ -1200,7 +5577,7 @@ void uploadImageToSession(int sessionId) {
     clearScreen();
     cout << "===== UPLOAD IMAGE TO SESSION =====" << endl;
    
-    StudySession* session = currentUser->getSession(sessionId);
+    optional<SessionView> session = currentUser->getSession(sessionId);
     if (!session) {
         cout << "Session not found." << endl;
         pauseExecution();
@@ -1224,9 +5601,9 @@ void uploadImageToSession(int sessionId) {
    
     string destPath;
     if (fileUploader.uploadFile(sourcePath, filename, destPath)) {
-        session->attachImage(destPath);
+        currentUser->attachImage(sessionId, destPath);
         cout << "Image uploaded successfully." << endl;
-        FileManager::saveUserData(currentUser->getId(), currentUser);
+        FileManager::logMutation(currentUser->getId(), currentUser, Journal::imageAttached(sessionId, destPath));
     } else {
         cout << "Failed to upload image." << endl;
     }
@@ -1239,7 +5616,7 @@ void uploadNotesToSession(int sessionId) {
     clearScreen();
     cout << "===== UPLOAD NOTES TO SESSION =====" << endl;
    
-    StudySession* session = currentUser->getSession(sessionId);
+    optional<SessionView> session = currentUser->getSession(sessionId);
     if (!session) {
         cout << "Session not found." << endl;
         pauseExecution();
@@ -1263,9 +5640,9 @@ void uploadNotesToSession(int sessionId) {
    
     string destPath;
     if (fileUploader.uploadFile(sourcePath, filename, destPath)) {
-        session->attachFile(destPath);
+        currentUser->attachFile(sessionId, destPath);
         cout << "Notes file uploaded successfully." << endl;
-        FileManager::saveUserData(currentUser->getId(), currentUser);
+        FileManager::logMutation(currentUser->getId(), currentUser, Journal::fileAttached(sessionId, destPath));
     } else {
         cout << "Failed to upload notes file." << endl;
     }
@@ -1278,7 +5655,7 @@ void viewSessionAttachments(int sessionId) {
     clearScreen();
     cout << "===== SESSION ATTACHMENTS =====" << endl;
    
-    StudySession* session = currentUser->getSession(sessionId);
+    optional<SessionView> session = currentUser->getSession(sessionId);
     if (!session) {
         cout << "Session not found." << endl;
         pauseExecution();
@@ -1288,14 +5665,14 @@ void viewSessionAttachments(int sessionId) {
     cout << "Session #" << sessionId << " - " << session->getSubject() << endl;
     cout << "------------------------------------" << endl;
    
-    string imagePath = session->getAttachedImage();
+    const string& imagePath = session->getAttachedImage();
     if (!imagePath.empty()) {
         cout << "Attached Image: " << imagePath << endl;
     } else {
         cout << "No image attached." << endl;
     }
    
-    vector<string> files = session->getAttachedFiles();
+    const vector<string>& files = session->getAttachedFiles();
     if (!files.empty()) {
         cout << "Attached Files:" << endl;
         for (size_t i = 0; i < files.size(); i++) {
@@ -1311,15 +5688,16 @@ void viewSessionAttachments(int sessionId) {
 void createBarChart() {
     BarChart chart(currentUser, "Time Per Subject");
    
-    if (currentUser->getAllSessions().empty()) {
+    if (currentUser->getSessionCount() == 0) {
         // Add sample data for demonstration when no sessions exist
         cout << "No study sessions found. Showing sample visualization data." << endl;
         chart.addDataPoint("Sample Math", 3600);  // 1 hour
         chart.addDataPoint("Sample Science", 1800);  // 30 minutes
     } else {
         // Use real data
-        map<string, int> timePerSubject = currentUser->getTimePerSubject();
-        for (const auto& pair : timePerSubject) chart.addDataPoint(pair.first, pair.second);
+        currentUser->forEachSubjectTotal([&chart](const string& subject, const User::SubjectTotals& totals) {
+            chart.addDataPoint(subject, totals.duration);
+        });
     }
    
     cout << "Rendering bar chart..." << endl;
@@ -1334,7 +5712,7 @@ void createBarChart() {
 void createPieChart() {
     PieChart chart(currentUser, "Subject Distribution");
    
-    if (currentUser->getAllSessions().empty()) {
+    if (currentUser->getSessionCount() == 0) {
         // Add sample data for demonstration when no sessions exist
         cout << "No study sessions found. Showing sample visualization data." << endl;
         chart.addDataPoint("Sample Math", 3600);  // 1 hour
@@ -1342,8 +5720,9 @@ void createPieChart() {
         chart.addDataPoint("Sample English", 2700);  // 45 minutes
     } else {
         // Use real data
-        map<string, int> timePerSubject = currentUser->getTimePerSubject();
-        for (const auto& pair : timePerSubject) chart.addDataPoint(pair.first, pair.second);
+        currentUser->forEachSubjectTotal([&chart](const string& subject, const User::SubjectTotals& totals) {
+            chart.addDataPoint(subject, totals.duration);
+        });
     }
    
     cout << "Rendering pie chart..." << endl;
@@ -1368,9 +5747,11 @@ void addTodoItem() {
    
     time_t dueDate = getDateInput("Enter due date (YYYY-MM-DD) or leave blank: ");
    
-    currentUser->getTodoList().addItem(description, priority, dueDate, subject);
+    int itemId = currentUser->addTodoItem(description, priority, dueDate, subject);
+    syncReminder(currentUser, itemId);
     cout << "Todo item added successfully." << endl;
-    FileManager::saveUserData(currentUser->getId(), currentUser);
+    FileManager::logMutation(currentUser->getId(), currentUser,
+                             Journal::todoAdded(*currentUser->getTodoList().getItem(itemId)));
     pauseExecution();
 }
 
@@ -1381,12 +5762,10 @@ void viewTodoList() {
     cout << "Sort: 1-Default, 2-Priority, 3-Due Date" << endl;
     int sortOption = getIntInput("Select sorting option: ");
    
-    vector<TodoItem> items;
-    switch (sortOption) {
-        case 2: items = currentUser->getTodoList().getItemsSortedByPriority(); break;
-        case 3: items = currentUser->getTodoList().getItemsSortedByDueDate(); break;
-        default: items = currentUser->getTodoList().getAllItems();
-    }
+    const TodoList& todoList = currentUser->getTodoList();
+    TodoView items = sortOption == 2 ? todoList.getItemsSortedByPriority()
+                   : sortOption == 3 ? todoList.getItemsSortedByDueDate()
+                   : todoList.getAllItems();
    
     if (items.empty()) {
         cout << "No todo items found." << endl;
@@ -1396,11 +5775,15 @@ void viewTodoList() {
     cout << "ID | Status | Description" << endl;
     cout << "-------------------------------------------" << endl;
    
+    TextBuffer out;
     for (const auto& item : items) {
-        cout << setw(3) << item.getId() << " | "
-                  << (item.isCompleted() ? "[X]" : "[ ]") << " | "
-                  << item.toString() << endl;
+        size_t field = out.size();
+        out << item.getId();
+        out.alignRight(field, 3) << " | " << (item.isCompleted() ? "[X]" : "[ ]") << " | ";
+        item.describe(out);
+        out << '\n';
     }
+    out.writeTo(cout);
    
     pauseExecution();
 }
@@ -1409,7 +5792,7 @@ void markTodoItemComplete() {
     clearScreen();
     cout << "===== MARK ITEM AS COMPLETE =====" << endl;
    
-    vector<TodoItem> items = currentUser->getTodoList().getIncompleteItems();
+    TodoView items = currentUser->getTodoList().getIncompleteItems();
     if (items.empty()) {
         cout << "No incomplete todo items found." << endl;
         pauseExecution();
@@ -1417,16 +5800,21 @@ void markTodoItemComplete() {
     }
    
     cout << "Incomplete items:" << endl;
+    TextBuffer out;
     for (const auto& item : items) {
-        cout << setw(3) << item.getId() << " | " << item.getDescription() << endl;
+        size_t field = out.size();
+        out << item.getId();
+        out.alignRight(field, 3) << " | " << item.getDescription() << '\n';
     }
+    out.writeTo(cout);
    
     int itemId = getIntInput("Enter item ID to mark as complete (0 to cancel): ");
     if (itemId == 0) return;
    
     if (currentUser->getTodoList().markAsCompleted(itemId)) {
+        syncReminder(currentUser, itemId);
         cout << "Item marked as complete." << endl;
-        FileManager::saveUserData(currentUser->getId(), currentUser);
+        FileManager::logMutation(currentUser->getId(), currentUser, Journal::todoCompleted(itemId, true));
     } else {
         cout << "Item not found or already complete." << endl;
     }
@@ -1437,7 +5825,7 @@ void removeTodoItem() {
     clearScreen();
     cout << "===== REMOVE TODO ITEM =====" << endl;
    
-    vector<TodoItem> items = currentUser->getTodoList().getAllItems();
+    TodoView items = currentUser->getTodoList().getAllItems();
     if (items.empty()) {
         cout << "No todo items found." << endl;
         pauseExecution();
@@ -1445,18 +5833,22 @@ void removeTodoItem() {
     }
    
     cout << "All items:" << endl;
+    TextBuffer out;
     for (const auto& item : items) {
-        cout << setw(3) << item.getId() << " | "
-                  << (item.isCompleted() ? "[X]" : "[ ]") << " | "
-                  << item.getDescription() << endl;
+        size_t field = out.size();
+        out << item.getId();
+        out.alignRight(field, 3) << " | " << (item.isCompleted() ? "[X]" : "[ ]") << " | "
+            << item.getDescription() << '\n';
     }
+    out.writeTo(cout);
    
     int itemId = getIntInput("Enter item ID to remove (0 to cancel): ");
     if (itemId == 0) return;
    
-    if (currentUser->getTodoList().removeItem(itemId)) {
+    if (currentUser->removeTodoItem(itemId)) {
+        syncReminder(currentUser, itemId);
         cout << "Item removed successfully." << endl;
-        FileManager::saveUserData(currentUser->getId(), currentUser);
+        FileManager::logMutation(currentUser->getId(), currentUser, Journal::todoRemoved(itemId));
     } else {
         cout << "Item not found." << endl;
     }
@@ -1467,66 +5859,121 @@ void generateReport() {
     clearScreen();
     cout << "===== STUDY REPORT =====" << endl;
    
-    vector<StudySession> sessions = currentUser->getAllSessions();
-    if (sessions.empty()) {
+    size_t sessionCount = currentUser->getSessionCount();
+    if (sessionCount == 0) {
         cout << "No study data available for report." << endl;
         pauseExecution();
         return;
     }
    
     int totalTime = currentUser->getTotalStudyTime();
-    map<string, int> timePerSubject = currentUser->getTimePerSubject();
+    vector<pair<const string*, User::SubjectTotals>> timePerSubject;
+    currentUser->forEachSubjectTotal([&timePerSubject](const string& subject, const User::SubjectTotals& totals) {
+        timePerSubject.emplace_back(&subject, totals);
+    });
    
     string mostStudiedSubject = "";
     int maxTime = 0;
     for (const auto& pair : timePerSubject) {
-        if (pair.second > maxTime) {
-            maxTime = pair.second;
-            mostStudiedSubject = pair.first;
+        if (pair.second.duration > maxTime) {
+            maxTime = pair.second.duration;
+            mostStudiedSubject = *pair.first;
         }
     }
    
-    cout << "Study Summary for " << currentUser->getFullName() << endl;
-    cout << "------------------------------------" << endl;
-    cout << "Total study sessions: " << sessions.size() << endl;
-    cout << "Total study time: " << Utils::formatDuration(totalTime) << endl;
-    cout << "Number of subjects: " << timePerSubject.size() << endl;
+    // Recent periods come straight from the day/week/month rollups
+    const StudyRollup& rollup = currentUser->getRollup();
+    int32_t today = rollup.dayOf(time(nullptr));
+    int32_t thisWeek = StudyRollup::weekOf(today);
+    int32_t thisMonth = rollup.monthOf(time(nullptr));
+   
+    // The report is formatted once; the screen and the saved file get the same bytes
+    TextBuffer out;
+    out << "Study Summary for " << currentUser->getFullName() << '\n';
+    out << "------------------------------------\n";
+    out << "Total study sessions: " << sessionCount << '\n';
+    out << "Total study time: ";
+    out.duration(totalTime) << '\n';
+    out << "Number of subjects: " << timePerSubject.size() << '\n';
    
     if (!mostStudiedSubject.empty()) {
-        cout << "Most studied: " << mostStudiedSubject << " ("
-                  << Utils::formatDuration(maxTime) << ")" << endl;
+        out << "Most studied: " << mostStudiedSubject << " (";
+        out.duration(maxTime) << ")\n";
     }
    
-    cout << "------------------------------------" << endl;
-    cout << "Time per subject:" << endl;
+    out << "------------------------------------\n";
+    out << "Time per subject:\n";
+   
+    for (const auto& pair : timePerSubject) {
+        out.column(*pair.first, 15) << ": ";
+        out.duration(pair.second.duration) << " (" << pair.second.sessionCount << " sessions)\n";
+    }
    
+    out << "------------------------------------\n";
+    out << "Recent activity:\n";
+    auto periodLine = [&out](const char* label, StudyRollup::Bucket current, StudyRollup::Bucket previous,
+                             const char* previousLabel) {
+        out.column(label, 15) << ": ";
+        out.duration(current.duration) << " in " << current.sessionCount << " sessions (" << previousLabel << ": ";
+        out.duration(previous.duration) << ")\n";
+    };
+    periodLine("Last 7 days", rollup.total(StudyRollup::Level::Day, today - 6, today),
+               rollup.total(StudyRollup::Level::Day, today - 13, today - 7), "previous 7 days");
+    periodLine("This week", rollup.total(StudyRollup::Level::Week, thisWeek, thisWeek),
+               rollup.total(StudyRollup::Level::Week, thisWeek - 7, thisWeek - 7), "last week");
+    periodLine("This month", rollup.total(StudyRollup::Level::Month, thisMonth, thisMonth),
+               rollup.total(StudyRollup::Level::Month, thisMonth - 1, thisMonth - 1), "last month");
+   
+    time_t weekAgo = time(nullptr) - 7 * 24 * 3600;
+    vector<int64_t> recentBySubject = currentUser->getStudyTimeBySubject(weekAgo, time(nullptr) + 1);
     for (const auto& pair : timePerSubject) {
-        cout << setw(15) << left << pair.first << ": "
-                  << Utils::formatDuration(pair.second) << endl;
+        SubjectId subject;
+        if (!currentUser->getSubjects().find(*pair.first, subject)) continue;
+        int64_t recent = recentBySubject[subject];
+        if (recent > 0) {
+            out << "  ";
+            out.column(*pair.first, 13) << ": ";
+            out.duration(static_cast<int>(recent)) << " in the last 7 days\n";
+        }
+    }
+   
+    // Session length distribution in 15 minute steps, from the duration column
+    const int BUCKET_SECONDS = 15 * 60;
+    vector<uint32_t> lengths = currentUser->getDurationHistogram(BUCKET_SECONDS, 8);
+    int shortest = 0, longest = 0;
+    currentUser->getDurationRange(shortest, longest);
+    out << "------------------------------------\n";
+    out << "Session lengths:\n";
+    out << "Shortest session: ";
+    out.duration(shortest) << " | Longest session: ";
+    out.duration(longest) << '\n';
+    for (size_t b = 0; b < lengths.size(); b++) {
+        size_t field = out.size();
+        out.duration(static_cast<int>(b * BUCKET_SECONDS)) << (b + 1 < lengths.size() ? "" : "+");
+        out.alignLeft(field, 15) << ": ";
+        out.repeat('#', min<uint32_t>(lengths[b], 40)) << ' ' << lengths[b] << '\n';
     }
    
+    // Median / p90 / p99 from the per-subject sketches, no sorting of sessions
+    User::SubjectSketches overall = currentUser->getOverallSketches();
+    out << "Focus length (median / p90 / p99):\n";
+    auto focusLine = [&out](const string& label, const QuantileSketch& sketch) {
+        if (sketch.size() == 0) return;
+        out.column(label, 15) << ": ";
+        out.duration(sketch.quantile(0.5)) << " / ";
+        out.duration(sketch.quantile(0.9)) << " / ";
+        out.duration(sketch.quantile(0.99)) << '\n';
+    };
+    focusLine("All subjects", overall.focus);
+    for (const auto& pair : timePerSubject) focusLine(*pair.first, currentUser->getSketches(*pair.first).focus);
+    focusLine("Breaks", overall.breaks);
+   
+    out.writeTo(cout);
+   
     if (getStringInput("Save this report to a file? (y/n): ") == "y") {
         ofstream file("study_report.txt");
         if (file.is_open()) {
-            file << "Study Summary for " << currentUser->getFullName() << endl;
-            file << "------------------------------------" << endl;
-            file << "Total study sessions: " << sessions.size() << endl;
-            file << "Total study time: " << Utils::formatDuration(totalTime) << endl;
-            file << "Number of subjects: " << timePerSubject.size() << endl;
-           
-            if (!mostStudiedSubject.empty()) {
-                file << "Most studied: " << mostStudiedSubject << " ("
-                     << Utils::formatDuration(maxTime) << ")" << endl;
-            }
-           
-            file << "------------------------------------" << endl;
-            file << "Time per subject:" << endl;
-           
-            for (const auto& pair : timePerSubject) {
-                file << setw(15) << left << pair.first << ": "
-                     << Utils::formatDuration(pair.second) << endl;
-            }
-           
+            out.writeTo(file);
             file.close();
             cout << "Report saved to study_report.txt" << endl;
         }
@@ -1536,7 +5983,7 @@ void generateReport() {
     if (getStringInput("Would you like to see a graphical pie chart of your study time? (y/n): ") == "y") {
         PieChart chart(currentUser, "Study Time Distribution");
         for (const auto& pair : timePerSubject) {
-            chart.addDataPoint(pair.first, pair.second);
+            chart.addDataPoint(*pair.first, pair.second.duration);
         }
         chart.renderSDL();
     }
@@ -1560,6 +6007,68 @@ void viewRankings() {
     cout << "Total Study Time: " << Utils::formatDuration(totalTime) << endl;
     cout << "Ranking Requirements:" << endl;
     cout << "Gold: 10+ hours | Silver: 5+ hours | Bronze: 1+ hour" << endl;
+   
+    // Overall standing comes from the leaderboard in O(log n)
+    auto printEntries = [](const vector<Leaderboard::Entry>& entries) {
+        TextBuffer out;
+        for (const auto& entry : entries) {
+            size_t field = out.size();
+            out << entry.rank;
+            out.alignRight(field, 6) << ". ";
+            out.column(entry.name, 20).duration(entry.total)
+               << (entry.userId == currentUser->getId() ? "  <- you" : "") << '\n';
+        }
+        out.writeTo(cout);
+    };
+    cout << "------------------------------------" << endl;
+    cout << "Leaderboard rank: #" << leaderboard.rankOf(currentUser->getId()) << " of " << leaderboard.size() << endl;
+    cout << "Top students:" << endl;
+    printEntries(leaderboard.top(5));
+    cout << "Around you:" << endl;
+    printEntries(leaderboard.around(currentUser->getId(), 2));
+   
+    // Per-subject standings need every user's breakdown, so they scan data/ on request
+    if (getStringInput("Compare each subject with all students? (y/n): ") == "y") {
+        FileManager::flush();   // our own pending writes go first
+        RankingEngine::Result ranking = RankingEngine::compute("data", currentUser->getId());
+        TextBuffer out;
+        out << "Across all " << ranking.usersScanned << " students (ahead of ";
+        out.decimal(ranking.overall.percentile, 1) << "%, median ";
+        out.duration(ranking.medianSeconds) << "):\n";
+        for (const auto& subject : ranking.bySubject) {
+            const QuantileSketch& cohort = ranking.cohortFocus[subject.first];
+            out.column(subject.first, 15) << ": #" << subject.second.rank << " of "
+                << subject.second.outOf << " (ahead of ";
+            out.decimal(subject.second.percentile, 1) << "%), typical session ";
+            out.duration(cohort.quantile(0.5)) << ", p90 ";
+            out.duration(cohort.quantile(0.9)) << '\n';
+        }
+        out.writeTo(cout);
+    }
+    pauseExecution();
+}
+
+void searchNotes() {
+    clearScreen();
+    cout << "===== SEARCH NOTES & TO-DOS =====" << endl;
+   
+    string query = getStringInput("Search for: ");
+    vector<TextIndex::Hit> hits = currentUser->search(query);
+    if (hits.empty()) {
+        cout << "No matches found." << endl;
+        pauseExecution();
+        return;
+    }
+   
+    for (const auto& hit : hits) {
+        if (hit.kind == TextIndex::Kind::Session) {
+            optional<SessionView> session = currentUser->getSession(hit.id);
+            if (session) cout << session->toString() << endl;
+        } else {
+            const TodoItem* item = currentUser->getTodoList().getItem(hit.id);
+            if (item) cout << "To-do #" << item->getId() << ": " << item->toString() << endl;
+        }
+    }
     pauseExecution();
 }
 
@@ -1569,12 +6078,14 @@ void displayMainMenu() {
         clearScreen();
         cout << "===== MAIN MENU =====" << endl;
         cout << "Welcome, " << currentUser->getFullName() << "!" << endl;
+        showReminders();
         cout << "1. Study Sessions" << endl;
         cout << "2. To-Do List" << endl;
         cout << "3. Visualizations" << endl;
         cout << "4. Reports" << endl;
         cout << "5. Rankings" << endl;
-        cout << "6. Logout" << endl;
+        cout << "6. Search Notes & To-Dos" << endl;
+        cout << "7. Logout" << endl;
        
         switch (getIntInput("Enter your choice: ")) {
             case 1: displayStudyMenu(); break;
@@ -1582,8 +6093,11 @@ void displayMainMenu() {
             case 3: displayVisualizationMenu(); break;
             case 4: generateReport(); break;
             case 5: viewRankings(); break;
-            case 6:
+            case 6: searchNotes(); break;
+            case 7:
                 FileManager::saveUserData(currentUser->getId(), currentUser);
+                FileManager::flush();
+                reminders.cancelUser(currentUser->getId());
                 currentUser = nullptr;
                 return;
             default:
@@ -1617,6 +6131,7 @@ void displayStudyMenu() {
     while (currentUser) {
         clearScreen();
         cout << "===== STUDY SESSIONS =====" << endl;
+        showReminders();
         cout << "1. Start Study Session" << endl;
         cout << "2. End Current Session" << endl;
         cout << "3. View Study History" << endl;
@@ -1675,6 +6190,7 @@ void displayTodoMenu() {
     while (currentUser) {
         clearScreen();
         cout << "===== TO-DO LIST =====" << endl;
+        showReminders();
         cout << "1. Add New Item" << endl;
         cout << "2. View Items" << endl;
         cout << "3. Mark Item as Complete" << endl;
@@ -1695,10 +6211,20 @@ void displayTodoMenu() {
 }
 
 int main() {
-    system("mkdir -p data");
+    fs::create_directories("data");
+    if (!userRegistry.open("users.db", "users.idx")) {
+        cerr << "Could not open the user registry (users.db)." << endl;
+        return 1;
+    }
+    if (!leaderboard.open("leaderboard.db", "leaderboard.log")) seedLeaderboard();
+    reminders.start();
+    if (const char* windowMs = getenv("STUDYSTAT_SAVE_WINDOW_MS"))
+        FileManager::setCoalesceWindow(chrono::milliseconds(atoi(windowMs)));
     displayLoginMenu();
-    for (auto user : users) {
-        delete user;
+    reminders.stop();
+    FileManager::shutdown();   // writes anything still queued
+    for (auto& entry : users) {
+        delete entry.second;
     }
     return 0;
 }